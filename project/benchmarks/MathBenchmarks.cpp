@@ -0,0 +1,130 @@
+//External includes
+#include <benchmark/benchmark.h>
+
+//Standard includes
+#include <random>
+#include <vector>
+
+//Project includes
+#include "Maths.h"
+
+using namespace dae;
+
+namespace
+{
+	//Rotation, scale and translation like a world matrix, invertible
+	Matrix CreateTestMatrix(float seed)
+	{
+		return Matrix::CreateScale(1.f + seed, 2.f, .5f) * Matrix::CreateRotation(seed, 2.f * seed, .5f * seed) * Matrix::CreateTranslation(seed, -seed, 3.f);
+	}
+
+	std::vector<Vector3> CreatePoints(size_t count)
+	{
+		std::mt19937 generator{ 42 };
+		std::uniform_real_distribution<float> distribution{ -100.f, 100.f };
+
+		std::vector<Vector3> points(count);
+		for (auto& p : points)
+			p = { distribution(generator), distribution(generator), distribution(generator) };
+		return points;
+	}
+}
+
+static void BM_MatrixMultiply(benchmark::State& state)
+{
+	Matrix const lhs{ CreateTestMatrix(.3f) };
+	Matrix rhs{ CreateTestMatrix(.7f) };
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(rhs);
+		benchmark::DoNotOptimize(lhs * rhs);
+	}
+}
+BENCHMARK(BM_MatrixMultiply);
+
+static void BM_MatrixInverse(benchmark::State& state)
+{
+	Matrix m{ CreateTestMatrix(.3f) };
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(m);
+		benchmark::DoNotOptimize(Matrix::Inverse(m));
+	}
+}
+BENCHMARK(BM_MatrixInverse);
+
+//Points as the vertex stage transforms them, w = 1 and the clip space result kept
+static void BM_TransformPoints(benchmark::State& state)
+{
+	Matrix const m{ CreateTestMatrix(.3f) };
+	std::vector<Vector3> const points{ CreatePoints(static_cast<size_t>(state.range(0))) };
+	std::vector<Vector4> transformed(points.size());
+
+	for (auto _ : state)
+	{
+		for (size_t i{ 0 }; i < points.size(); ++i)
+			transformed[i] = m.TransformPoint(Vector4{ points[i], 1.f });
+		benchmark::DoNotOptimize(transformed.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransformPoints)->RangeMultiplier(8)->Range(1 << 9, 1 << 21);
+
+//The same points through the batch kernel
+static void BM_TransformPointsBatch(benchmark::State& state)
+{
+	Matrix const m{ CreateTestMatrix(.3f) };
+	std::vector<Vector3> const points{ CreatePoints(static_cast<size_t>(state.range(0))) };
+	std::vector<Vector4> transformed(points.size());
+
+	for (auto _ : state)
+	{
+		m.TransformPoints(points, transformed);
+		benchmark::DoNotOptimize(transformed.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransformPointsBatch)->RangeMultiplier(8)->Range(1 << 9, 1 << 21);
+
+//The same points as separate x, y and z streams, four per step
+static void BM_TransformPointsSoA(benchmark::State& state)
+{
+	Matrix const m{ CreateTestMatrix(.3f) };
+	std::vector<Vector3> const points{ CreatePoints(static_cast<size_t>(state.range(0))) };
+
+	std::vector<float> x(points.size()), y(points.size()), z(points.size());
+	for (size_t i{ 0 }; i < points.size(); ++i)
+	{
+		x[i] = points[i].x;
+		y[i] = points[i].y;
+		z[i] = points[i].z;
+	}
+	std::vector<float> outX(points.size()), outY(points.size()), outZ(points.size()), outW(points.size());
+
+	for (auto _ : state)
+	{
+		m.TransformPoints(x, y, z, outX, outY, outZ, outW);
+		benchmark::DoNotOptimize(outW.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransformPointsSoA)->RangeMultiplier(8)->Range(1 << 9, 1 << 21);
+
+static void BM_Vector3Normalized(benchmark::State& state)
+{
+	std::vector<Vector3> const vectors{ CreatePoints(static_cast<size_t>(state.range(0))) };
+	std::vector<Vector3> normalized(vectors.size());
+
+	for (auto _ : state)
+	{
+		for (size_t i{ 0 }; i < vectors.size(); ++i)
+			normalized[i] = vectors[i].Normalized();
+		benchmark::DoNotOptimize(normalized.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Vector3Normalized)->RangeMultiplier(8)->Range(1 << 9, 1 << 21);
@@ -0,0 +1,32 @@
+//External includes
+#include <benchmark/benchmark.h>
+
+//Standard includes
+#include <vector>
+
+//Project includes
+#include "DataTypes.h"
+#include "Utils.h"
+
+using namespace dae;
+
+static void BM_ParseOBJ(benchmark::State& state)
+{
+	std::vector<Vertex> vertices{};
+	std::vector<uint32_t> indices{};
+
+	for (auto _ : state)
+	{
+		if (!Utils::ParseOBJ("resources/vehicle.obj", vertices, indices))
+		{
+			state.SkipWithError("resources/vehicle.obj not found");
+			break;
+		}
+		benchmark::DoNotOptimize(vertices.data());
+		benchmark::DoNotOptimize(indices.data());
+	}
+
+	state.counters["vertices"] = static_cast<double>(vertices.size());
+	state.counters["triangles"] = static_cast<double>(indices.size() / 3);
+}
+BENCHMARK(BM_ParseOBJ)->Unit(benchmark::kMillisecond);
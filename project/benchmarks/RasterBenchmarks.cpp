@@ -0,0 +1,96 @@
+//External includes
+#include <benchmark/benchmark.h>
+
+//Standard includes
+#include <memory>
+
+//Project includes
+#include "DataTypes.h"
+#include "Renderer.h"
+
+using namespace dae;
+
+namespace
+{
+	int constexpr Width{ 640 };
+	int constexpr Height{ 480 };
+	//Distance of the plane the triangles lie in
+	float constexpr Distance{ 10.f };
+
+	//Square region of cellSize x cellSize pixel cells, two triangles per cell, facing the camera of PlaceCamera
+	std::shared_ptr<MeshData> CreateTriangleGrid(Camera const& camera, int cellSize)
+	{
+		//world units per pixel on the plane
+		float const unitsPerPixelX{ 2.f * camera.aspectRatio * camera.fov * Distance / Width };
+		float const unitsPerPixelY{ 2.f * camera.fov * Distance / Height };
+
+		//most of the screen, every vertex has to stay inside the view or the triangle is clipped
+		int const cellCount{ std::max(Height * 9 / 10 / cellSize, 1) };
+		auto const pMesh{ Renderer::CreateGrid(cellCount * cellSize * unitsPerPixelX, cellCount * cellSize * unitsPerPixelY, static_cast<uint32_t>(cellCount)) };
+
+		pMesh->pDiffuse = std::make_shared<Texture>("resources/vehicle_diffuse.png");
+		pMesh->pNormal = std::make_shared<Texture>("resources/vehicle_normal.png");
+		pMesh->pSpecular = std::make_shared<Texture>("resources/vehicle_specular.png");
+		pMesh->pGloss = std::make_shared<Texture>("resources/vehicle_gloss.png");
+		return pMesh;
+	}
+
+	void PlaceCamera(Camera& camera)
+	{
+		camera.LookAt({ 0.f, 0.f, -Distance }, Vector3::Zero);
+	}
+
+	//Draws the same frame every iteration, a dirty camera keeps the renderer from presenting the previous frame again
+	void RenderGrid(benchmark::State& state, int cellSize, Renderer::ShadingMode mode, uint32_t sampleCount = 1)
+	{
+		//the field of view and aspect ratio the renderer gives its camera
+		Camera placement{};
+		placement.Initialize(45.f, {}, static_cast<float>(Width / Height));
+
+		Renderer renderer{ Width, Height, CreateTriangleGrid(placement, cellSize) };
+		renderer.SetShadingMode(mode);
+		renderer.SetSampleCount(sampleCount);
+		Camera& camera{ renderer.GetCamera() };
+		PlaceCamera(camera);
+
+		for (auto _ : state)
+		{
+			camera.isDirty = true;
+			renderer.Render();
+		}
+
+		RenderStats const& stats{ renderer.GetStats() };
+		state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(stats.trianglesRasterized));
+		state.counters["triangles"] = static_cast<double>(stats.trianglesRasterized);
+		state.counters["pixels"] = static_cast<double>(stats.pixelsShaded);
+		state.counters["pixelsPerSecond"] = benchmark::Counter(static_cast<double>(stats.pixelsShaded), benchmark::Counter::kIsIterationInvariantRate);
+		if (sampleCount > 1)
+		{
+			state.counters["sampleColorBytes"] = static_cast<double>(stats.sampleColorBytes);
+			state.counters["resolveMs"] = stats.resolveMs;
+		}
+	}
+}
+
+//range(0) is the size of a grid cell in pixels, the triangles cover half a cell each
+//small triangles are dominated by setup, large ones by the pixel loop
+static void BM_RenderTriangles(benchmark::State& state)
+{
+	RenderGrid(state, static_cast<int>(state.range(0)), Renderer::ShadingMode::ObservedArea);
+}
+BENCHMARK(BM_RenderTriangles)->ArgName("cellSize")->Arg(2)->Arg(8)->Arg(32)->Arg(128)->Unit(benchmark::kMillisecond);
+
+//Two triangles over most of the screen, the cost of PixelShading per mode
+static void BM_PixelShading(benchmark::State& state)
+{
+	RenderGrid(state, Height * 9 / 10, static_cast<Renderer::ShadingMode>(state.range(0)));
+}
+BENCHMARK(BM_PixelShading)->ArgName("mode")->DenseRange(0, static_cast<int>(Renderer::ShadingMode::Count) - 1)->Unit(benchmark::kMillisecond);
+
+//range(0) samples per pixel, 8 pixel cells put a triangle edge in most pixels so coverage and the resolve are stressed
+//shading still runs once per pixel and triangle
+static void BM_Multisample(benchmark::State& state)
+{
+	RenderGrid(state, 8, Renderer::ShadingMode::Combined, static_cast<uint32_t>(state.range(0)));
+}
+BENCHMARK(BM_Multisample)->ArgName("samples")->RangeMultiplier(2)->Range(1, 8)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,78 @@
+//External includes
+#include <benchmark/benchmark.h>
+
+//Standard includes
+#include <random>
+#include <vector>
+
+//Project includes
+#include "Texture.h"
+#include "Vector2.h"
+
+using namespace dae;
+
+namespace
+{
+	enum class AccessPattern
+	{
+		//neighbouring texels along a row, like a triangle facing the camera
+		Rows,
+		//neighbouring texels down a column, every sample lands on another row of the texture
+		Columns,
+		//no locality at all
+		Random,
+		//magnified far enough that every sample reads the same texel
+		SameTexel
+	};
+
+	std::vector<Vector2> CreateUVs(AccessPattern pattern, size_t count)
+	{
+		//about a texel apart for textures up to 2048 wide
+		float constexpr step{ 1.f / 2048.f };
+
+		std::vector<Vector2> uvs(count);
+		std::mt19937 generator{ 42 };
+		std::uniform_real_distribution<float> distribution{ 0.f, 1.f };
+
+		for (size_t i{ 0 }; i < count; ++i)
+		{
+			float const along{ (i % 2048) * step };
+			float const across{ (i / 2048) * step * 16.f };
+
+			switch (pattern)
+			{
+			case AccessPattern::Rows:
+				uvs[i] = { along, across };
+				break;
+			case AccessPattern::Columns:
+				uvs[i] = { across, along };
+				break;
+			case AccessPattern::Random:
+				uvs[i] = { distribution(generator), distribution(generator) };
+				break;
+			case AccessPattern::SameTexel:
+				uvs[i] = { .5f, .5f };
+				break;
+			}
+		}
+		return uvs;
+	}
+}
+
+//range(0) is the AccessPattern, range(1) the samples per iteration
+static void BM_TextureSample(benchmark::State& state)
+{
+	Texture const texture{ "resources/vehicle_diffuse.png" };
+	std::vector<Vector2> const uvs{ CreateUVs(static_cast<AccessPattern>(state.range(0)), static_cast<size_t>(state.range(1))) };
+
+	for (auto _ : state)
+	{
+		for (Vector2 const& uv : uvs)
+			benchmark::DoNotOptimize(texture.Sample(uv));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_TextureSample)
+	->ArgNames({ "pattern", "samples" })
+	->ArgsProduct({ { static_cast<int>(AccessPattern::Rows), static_cast<int>(AccessPattern::Columns), static_cast<int>(AccessPattern::Random), static_cast<int>(AccessPattern::SameTexel) },
+		{ 1 << 12, 1 << 18 } });
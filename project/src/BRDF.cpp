@@ -0,0 +1,116 @@
+#include "BRDF.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dae
+{
+	namespace BRDF
+	{
+		namespace
+		{
+			//Van der Corput radical inverse, used to generate a low discrepancy Hammersley sequence
+			float RadicalInverse(uint32_t bits)
+			{
+				bits = (bits << 16u) | (bits >> 16u);
+				bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+				bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+				bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+				bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+				return static_cast<float>(bits) * 2.3283064365386963e-10f;
+			}
+
+			//Returns a half vector around the normal (0, 0, 1) distributed according to GGX
+			Vector3 ImportanceSampleGGX(float u, float v, float roughness)
+			{
+				float const alpha{ Square(roughness) };
+				float const phi{ PI_2 * u };
+				float const cosTheta{ sqrtf((1.f - v) / (1.f + (Square(alpha) - 1.f) * v)) };
+				float const sinTheta{ sqrtf(1.f - Square(cosTheta)) };
+
+				return { sinTheta * cosf(phi), sinTheta * sinf(phi), cosTheta };
+			}
+
+			Vector2 Lerp(const Vector2& a, const Vector2& b, float factor)
+			{
+				return a + (b - a) * factor;
+			}
+
+			//Smith geometry term with the IBL remapping of k
+			float GeometrySmithIBL(float cosView, float cosLight, float roughness)
+			{
+				float const k{ Square(roughness) / 2.f };
+				float const gView{ cosView / (cosView * (1.f - k) + k) };
+				float const gLight{ cosLight / (cosLight * (1.f - k) + k) };
+				return gView * gLight;
+			}
+		}
+
+		DFGLookupTable::DFGLookupTable(uint32_t size, uint32_t sampleCount) :
+			m_Size{ size }
+		{
+			m_Data.resize(static_cast<size_t>(m_Size) * m_Size);
+
+			for (uint32_t r{ 0 }; r < m_Size; ++r)
+			{
+				float const roughness{ (r + .5f) / m_Size };
+				for (uint32_t c{ 0 }; c < m_Size; ++c)
+				{
+					float const cosView{ (c + .5f) / m_Size };
+					m_Data[c + r * m_Size] = Integrate(cosView, roughness, sampleCount);
+				}
+			}
+		}
+
+		Vector2 DFGLookupTable::Integrate(float cosView, float roughness, uint32_t sampleCount) const
+		{
+			Vector3 const view{ sqrtf(1.f - Square(cosView)), 0.f, cosView };
+
+			float scale{};
+			float bias{};
+			for (uint32_t i{ 0 }; i < sampleCount; ++i)
+			{
+				Vector3 const halfVector{ ImportanceSampleGGX(static_cast<float>(i) / sampleCount, RadicalInverse(i), roughness) };
+				float const cosViewHalf{ Vector3::Dot(view, halfVector) };
+				Vector3 const light{ 2.f * cosViewHalf * halfVector - view };
+
+				float const cosLight{ Saturate(light.z) };
+				if (cosLight <= 0.f)
+					continue;
+
+				float const cosHalf{ Saturate(halfVector.z) };
+				float const visibility{ GeometrySmithIBL(cosView, cosLight, roughness) * Saturate(cosViewHalf) / (cosHalf * cosView) };
+				float const fresnel{ powf(1.f - Saturate(cosViewHalf), 5.f) };
+
+				scale += (1.f - fresnel) * visibility;
+				bias += fresnel * visibility;
+			}
+
+			return { scale / sampleCount, bias / sampleCount };
+		}
+
+		Vector2 DFGLookupTable::Sample(float cosView, float roughness) const
+		{
+			//texel centers are at (i + .5) / size, clamp to the edge texels
+			float const x{ Clamp(Saturate(cosView) * m_Size - .5f, 0.f, m_Size - 1.f) };
+			float const y{ Clamp(Saturate(roughness) * m_Size - .5f, 0.f, m_Size - 1.f) };
+
+			uint32_t const x0{ static_cast<uint32_t>(x) };
+			uint32_t const y0{ static_cast<uint32_t>(y) };
+			uint32_t const x1{ std::min(x0 + 1, m_Size - 1) };
+			uint32_t const y1{ std::min(y0 + 1, m_Size - 1) };
+			float const fx{ x - x0 };
+			float const fy{ y - y0 };
+
+			Vector2 const top{ Lerp(m_Data[x0 + y0 * m_Size], m_Data[x1 + y0 * m_Size], fx) };
+			Vector2 const bottom{ Lerp(m_Data[x0 + y1 * m_Size], m_Data[x1 + y1 * m_Size], fx) };
+			return Lerp(top, bottom, fy);
+		}
+
+		ColorRGB DFGLookupTable::Evaluate(const ColorRGB& f0, float cosView, float roughness) const
+		{
+			Vector2 const scaleBias{ Sample(cosView, roughness) };
+			return f0 * scaleBias.x + ColorRGB{ scaleBias.y, scaleBias.y, scaleBias.y };
+		}
+	}
+}
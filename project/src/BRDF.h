@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include "Maths.h"
 #include "Vector3.h"
 #include "ColorRGB.h"
@@ -23,5 +26,149 @@ namespace dae
 			return { (kd * cd) / PI };
 		}
 
+		/**
+		 * \param ks Specular Reflection Coefficient
+		 * \param exp Phong Exponent
+		 * \param l Incoming (incident) Light Direction
+		 * \param v View Direction
+		 * \param n Normal of the Surface
+		 * \return Phong Specular Color
+		 */
+		static ColorRGB Phong(const ColorRGB& ks, float exp, const Vector3& l, const Vector3& v, const Vector3& n)
+		{
+			Vector3 const reflect{ Vector3::Reflect(l, n) };
+			float const cosAngle{ Vector3::Dot(reflect, v) };
+			if (cosAngle <= 0.f)
+				return {};
+
+			return ks * powf(cosAngle, exp);
+		}
+
+		/**
+		 * \param ks Specular Reflection Coefficient
+		 * \param exp Specular Exponent
+		 * \param l Direction towards the light
+		 * \param v Direction towards the viewer
+		 * \param n Normal of the Surface
+		 * \return Blinn-Phong Specular Color
+		 */
+		static ColorRGB BlinnPhong(const ColorRGB& ks, float exp, const Vector3& l, const Vector3& v, const Vector3& n)
+		{
+			Vector3 const halfVector{ (l + v).Normalized() };
+			float const cosAngle{ Vector3::Dot(n, halfVector) };
+			if (cosAngle <= 0.f)
+				return {};
+
+			return ks * powf(cosAngle, exp);
+		}
+
+		/**
+		 * \brief BRDF Fresnel Function >> Schlick
+		 * \param h Normalized Halfvector between View and Light directions
+		 * \param v Normalized direction towards the viewer
+		 * \param f0 Base reflectivity of a surface based on IOR (Indices Of Refrection), this is different for Dielectrics (Non-Metal) and Conductors (Metal)
+		 * \return Fresnel reflectance
+		 */
+		static ColorRGB FresnelFunction_Schlick(const Vector3& h, const Vector3& v, const ColorRGB& f0)
+		{
+			float const cosTheta{ Saturate(Vector3::Dot(h, v)) };
+			float const factor{ powf(1.f - cosTheta, 5.f) };
+
+			return f0 + (ColorRGB{ 1.f, 1.f, 1.f } - f0) * factor;
+		}
+
+		/**
+		 * \brief BRDF NormalDistribution >> Trowbridge-Reitz GGX (UE4 implemetation - squared(roughness))
+		 * \param n Surface normal
+		 * \param h Normalized half vector
+		 * \param roughness Roughness of the material
+		 * \return Normal Distribution Term
+		 */
+		static float NormalDistribution_GGX(const Vector3& n, const Vector3& h, float roughness)
+		{
+			float const alphaSqr{ Square(Square(roughness)) };
+			float const cosTheta{ Saturate(Vector3::Dot(n, h)) };
+			float const denominator{ Square(cosTheta) * (alphaSqr - 1.f) + 1.f };
+
+			return alphaSqr / (PI * Square(denominator));
+		}
+
+		/**
+		 * \brief BRDF Geometry Function >> Schlick GGX (Direct Lighting + UE4 implementation - squared(roughness))
+		 * \param n Normal of the surface
+		 * \param v Normalized view direction (or light direction when used for shadowing)
+		 * \param roughness Roughness of the material
+		 * \return Schlick GGX Geometry Term
+		 */
+		static float GeometryFunction_SchlickGGX(const Vector3& n, const Vector3& v, float roughness)
+		{
+			float const k{ Square(Square(roughness) + 1.f) / 8.f };
+			float const cosTheta{ Saturate(Vector3::Dot(n, v)) };
+
+			return cosTheta / (cosTheta * (1.f - k) + k);
+		}
+
+		/**
+		 * \brief BRDF Geometry Function >> Smith (Direct Lighting)
+		 * \param n Normal of the surface
+		 * \param v Normalized direction towards the viewer
+		 * \param l Normalized direction towards the light
+		 * \param roughness Roughness of the material
+		 * \return Smith Geometry Term (masking * shadowing)
+		 */
+		static float GeometryFunction_Smith(const Vector3& n, const Vector3& v, const Vector3& l, float roughness)
+		{
+			return GeometryFunction_SchlickGGX(n, v, roughness) * GeometryFunction_SchlickGGX(n, l, roughness);
+		}
+
+		/**
+		 * \brief Cook-Torrance specular term (GGX distribution, Schlick Fresnel, Smith geometry)
+		 * \param n Normal of the surface
+		 * \param v Normalized direction towards the viewer
+		 * \param l Normalized direction towards the light
+		 * \param f0 Base reflectivity of the surface
+		 * \param roughness Roughness of the material
+		 * \param fresnel Out parameter receiving the Fresnel term, used to weight the diffuse part
+		 * \return Cook-Torrance Specular Color
+		 */
+		static ColorRGB CookTorrance(const Vector3& n, const Vector3& v, const Vector3& l, const ColorRGB& f0, float roughness, ColorRGB& fresnel)
+		{
+			float const cosView{ Vector3::Dot(n, v) };
+			float const cosLight{ Vector3::Dot(n, l) };
+			fresnel = {};
+			if (cosView <= 0.f || cosLight <= 0.f)
+				return {};
+
+			Vector3 const halfVector{ (v + l).Normalized() };
+
+			fresnel = FresnelFunction_Schlick(halfVector, v, f0);
+			float const D{ NormalDistribution_GGX(n, halfVector, roughness) };
+			float const G{ GeometryFunction_Smith(n, v, l, roughness) };
+
+			return fresnel * (D * G / (4.f * cosView * cosLight));
+		}
+
+		/**
+		 * Split-sum DFG lookup table (Karis 2013) used for the specular ambient term.
+		 * Stores the scale (x) and bias (y) applied to F0, indexed by N.V and roughness.
+		 * Built once at startup by importance sampling the GGX distribution.
+		 */
+		class DFGLookupTable final
+		{
+		public:
+			DFGLookupTable(uint32_t size = 32, uint32_t sampleCount = 128);
+
+			//Bilinearly filtered lookup, returns { scale, bias }
+			Vector2 Sample(float cosView, float roughness) const;
+
+			//Evaluates F0 * scale + bias
+			ColorRGB Evaluate(const ColorRGB& f0, float cosView, float roughness) const;
+
+		private:
+			uint32_t m_Size{};
+			std::vector<Vector2> m_Data{};
+
+			Vector2 Integrate(float cosView, float roughness, uint32_t sampleCount) const;
+		};
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,255 @@
+#include "BatchRenderer.h"
+
+//Standard includes
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+//Project includes
+#include "DataTypes.h"
+#include "Profiler.h"
+#include "RenderTarget.h"
+
+namespace dae
+{
+	namespace
+	{
+		//uniform Catmull-Rom segment between p1 and p2
+		Vector3 CatmullRom(Vector3 const& p0, Vector3 const& p1, Vector3 const& p2, Vector3 const& p3, float t)
+		{
+			float const t2{ t * t };
+			float const t3{ t2 * t };
+
+			return (p1 * 2.f
+				+ (p2 - p0) * t
+				+ (p0 * 2.f - p1 * 5.f + p2 * 4.f - p3) * t2
+				+ (p1 * 3.f - p0 - p2 * 3.f + p3) * t3) * .5f;
+		}
+	}
+
+	BatchRenderer::BatchRenderer(std::shared_ptr<MeshData const> pMesh) :
+		m_pMesh{ std::move(pMesh) }
+	{
+		assert(m_pMesh);
+	}
+
+	BatchResult BatchRenderer::Render(std::vector<CameraPose> const& poses, BatchSettings const& settings) const
+	{
+		BatchResult result{};
+		result.frameCount = static_cast<uint32_t>(poses.size());
+		if (poses.empty())
+			return result;
+
+		result.threadCount = settings.threadCount ? settings.threadCount : std::max(1u, std::thread::hardware_concurrency());
+		result.threadCount = std::min(result.threadCount, result.frameCount);
+
+		bool const writeImages{ !settings.outputDirectory.empty() };
+		if (writeImages)
+			std::filesystem::create_directories(settings.outputDirectory);
+
+		//The far plane has to keep the whole mesh in view from every pose, the default one is fitted to the interactive camera
+		BoundingSphere const bounds{ GetInstanceBounds(m_pMesh->boundingSphere, settings.instances) };
+		float farPlane{};
+		for (auto const& pose : poses)
+			farPlane = std::max(farPlane, (bounds.center - pose.origin).Magnitude() + bounds.radius);
+
+		auto const start{ std::chrono::steady_clock::now() };
+
+		//Workers only copy their frame into the writer's queue, a full queue makes them wait for the encoders
+		ImageWriter writer{ settings.writerThreadCount, result.threadCount * 2 };
+
+		//Frames are handed out one at a time, a slow frame doesn't hold back the frames behind it
+		std::atomic<uint32_t> nextFrame{ 0 };
+		std::atomic<uint32_t> nextWorker{ 0 };
+		std::mutex statsMutex{};
+
+		auto const worker{ [&]()
+		{
+			Profiler::SetThreadName("Batch Worker " + std::to_string(nextWorker.fetch_add(1, std::memory_order_relaxed)));
+
+			Renderer renderer{ settings.width, settings.height, m_pMesh };
+			renderer.SetShadingMode(settings.shadingMode);
+			renderer.SetDepthFormat(settings.depthFormat);
+			renderer.SetSampleCount(settings.sampleCount);
+			if (!settings.instances.empty())
+				renderer.SetInstances(0, settings.instances);
+			if (settings.isCountingPerf)
+				renderer.EnablePerfCounters();
+
+			Camera& camera{ renderer.GetCamera() };
+			camera.farPlane = std::max(camera.farPlane, farPlane);
+			camera.CalculateProjectionMatrix();
+
+			RenderStats renderStats{};
+			for (uint32_t frame{ nextFrame.fetch_add(1, std::memory_order_relaxed) }; frame < result.frameCount;
+				frame = nextFrame.fetch_add(1, std::memory_order_relaxed))
+			{
+				camera.LookAt(poses[frame].origin, poses[frame].target);
+				renderer.Render();
+				renderStats += renderer.GetStats();
+
+				//Waits here while the writer's queue is full
+				if (writeImages)
+				{
+					PROFILE_SCOPE("Submit");
+					writer.Submit(renderer.GetRenderTarget(), ImageWriter::GetSequencePath(settings.outputDirectory, frame, settings.imageFormat), settings.imageFormat);
+				}
+			}
+
+			std::lock_guard const lock{ statsMutex };
+			result.depthStats += renderer.GetDepthBuffer().GetStats();
+			result.renderStats += renderStats;
+		} };
+
+		std::vector<std::thread> workers{};
+		workers.reserve(result.threadCount);
+		for (uint32_t i{ 0 }; i < result.threadCount; ++i)
+			workers.emplace_back(worker);
+
+		for (auto& thread : workers)
+			thread.join();
+
+		result.failedWrites = writer.Flush();
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return result;
+	}
+
+	std::vector<CameraPose> BatchRenderer::LoadPoses(std::filesystem::path const& path)
+	{
+		std::ifstream file{ path };
+		if (!file)
+			throw std::runtime_error("Failed to open camera poses: " + path.string());
+
+		std::vector<CameraPose> poses{};
+
+		std::string line{};
+		uint32_t lineNumber{ 0 };
+		while (std::getline(file, line))
+		{
+			++lineNumber;
+
+			size_t const first{ line.find_first_not_of(" \t\r") };
+			if (first == std::string::npos || line[first] == '#')
+				continue;
+
+			std::istringstream stream{ line };
+			CameraPose pose{};
+			if (!(stream >> pose.origin.x >> pose.origin.y >> pose.origin.z >> pose.target.x >> pose.target.y >> pose.target.z))
+				throw std::runtime_error("Invalid camera pose on line " + std::to_string(lineNumber) + " of " + path.string());
+
+			poses.emplace_back(pose);
+		}
+
+		return poses;
+	}
+
+	std::vector<CameraPose> BatchRenderer::SamplePath(std::vector<CameraPose> const& controlPoses, uint32_t frameCount)
+	{
+		std::vector<CameraPose> poses{};
+		if (controlPoses.empty() || frameCount == 0)
+			return poses;
+
+		if (controlPoses.size() == 1 || frameCount == 1)
+			return std::vector<CameraPose>(frameCount, controlPoses.front());
+
+		poses.reserve(frameCount);
+
+		int const lastPose{ static_cast<int>(controlPoses.size()) - 1 };
+		for (uint32_t i{ 0 }; i < frameCount; ++i)
+		{
+			//position on the whole path in segments, the end points are repeated to give the outer segments a tangent
+			float const t{ static_cast<float>(i) * lastPose / (frameCount - 1) };
+			int const segment{ std::min(static_cast<int>(t), lastPose - 1) };
+			float const u{ t - segment };
+
+			CameraPose const& p0{ controlPoses[std::max(segment - 1, 0)] };
+			CameraPose const& p1{ controlPoses[segment] };
+			CameraPose const& p2{ controlPoses[segment + 1] };
+			CameraPose const& p3{ controlPoses[std::min(segment + 2, lastPose)] };
+
+			poses.emplace_back(CameraPose{
+				CatmullRom(p0.origin, p1.origin, p2.origin, p3.origin, u),
+				CatmullRom(p0.target, p1.target, p2.target, p3.target, u) });
+		}
+
+		return poses;
+	}
+
+	std::vector<CameraPose> BatchRenderer::Turntable(BoundingSphere const& bounds, float fovAngle, uint32_t frameCount)
+	{
+		float constexpr elevation{ 20.f * TO_RADIANS };
+		float constexpr margin{ 1.1f };
+
+		//distance at which the sphere touches the edges of the view
+		float const distance{ bounds.radius / sinf(fovAngle * TO_RADIANS * .5f) * margin };
+
+		std::vector<CameraPose> poses{};
+		poses.reserve(frameCount);
+
+		for (uint32_t i{ 0 }; i < frameCount; ++i)
+		{
+			//starts behind the mesh on -z, like the interactive camera
+			float const angle{ PI_2 * i / frameCount };
+			Vector3 const direction{ sinf(angle) * cosf(elevation), sinf(elevation), -cosf(angle) * cosf(elevation) };
+
+			poses.emplace_back(CameraPose{ bounds.center + direction * distance, bounds.center });
+		}
+
+		return poses;
+	}
+
+	std::vector<Instance> BatchRenderer::CreateInstanceGrid(BoundingSphere const& bounds, uint32_t count)
+	{
+		static ColorRGB const tints[]{ colors::White, { 1.f, .6f, .6f }, { .6f, 1.f, .6f }, { .6f, .6f, 1.f }, { 1.f, 1.f, .6f }, { 1.f, .6f, 1.f }, { .6f, 1.f, 1.f } };
+
+		uint32_t const columns{ static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(count)))) };
+		uint32_t const rows{ columns ? (count + columns - 1) / columns : 0 };
+		float const spacing{ bounds.radius * 2.2f };
+
+		std::vector<Instance> instances{};
+		instances.reserve(count);
+		for (uint32_t i{ 0 }; i < count; ++i)
+		{
+			float const x{ (i % columns - (columns - 1) * .5f) * spacing };
+			float const z{ (i / columns - (rows - 1) * .5f) * spacing };
+
+			//turned around the mesh center, then moved to its place in the grid
+			Instance instance{};
+			instance.worldMatrix = Matrix::CreateTranslation(-bounds.center)
+				* Matrix::CreateRotationY(static_cast<float>(i) * 15.f * TO_RADIANS)
+				* Matrix::CreateTranslation(bounds.center + Vector3{ x, 0.f, z });
+			instance.color = tints[i % std::size(tints)];
+			instances.emplace_back(instance);
+		}
+
+		return instances;
+	}
+
+	BoundingSphere BatchRenderer::GetInstanceBounds(BoundingSphere const& bounds, std::vector<Instance> const& instances)
+	{
+		if (instances.empty())
+			return bounds;
+
+		//instances don't scale, every copy has the radius of the mesh
+		Vector3 center{};
+		for (Instance const& instance : instances)
+			center += instance.worldMatrix.TransformPoint(bounds.center);
+		center /= static_cast<float>(instances.size());
+
+		float radius{};
+		for (Instance const& instance : instances)
+			radius = std::max(radius, (instance.worldMatrix.TransformPoint(bounds.center) - center).Magnitude() + bounds.radius);
+
+		return { center, radius };
+	}
+}
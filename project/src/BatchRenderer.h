@@ -0,0 +1,93 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+//Project includes
+#include "DataTypes.h"
+#include "ImageWriter.h"
+#include "Maths.h"
+#include "Renderer.h"
+
+namespace dae
+{
+	//Camera placement of a single frame
+	struct CameraPose
+	{
+		Vector3 origin{};
+		Vector3 target{};
+	};
+
+	struct BatchSettings
+	{
+		int width{ 640 };
+		int height{ 480 };
+		Renderer::ShadingMode shadingMode{ Renderer::ShadingMode::ObservedArea };
+		DepthFormat depthFormat{ DepthFormat::Float32 };
+		//samples per pixel, see Renderer::SetSampleCount
+		uint32_t sampleCount{ 1 };
+		//hardware events per stage in the render stats, see Renderer::EnablePerfCounters
+		bool isCountingPerf{ false };
+		//copies of the mesh drawn through the instanced path, see CreateInstanceGrid, empty draws the mesh once
+		std::vector<Instance> instances{};
+
+		//0 uses every hardware thread
+		uint32_t threadCount{ 0 };
+
+		//frames are written as frame_00000.png, ..., empty only renders
+		std::filesystem::path outputDirectory{ "batch" };
+		ImageFormat imageFormat{ ImageFormat::PNG };
+		//encoding runs next to the workers, more writers help when encoding is slower than rendering
+		uint32_t writerThreadCount{ 1 };
+	};
+
+	struct BatchResult
+	{
+		uint32_t frameCount{};
+		uint32_t threadCount{};
+		uint32_t failedWrites{};
+		//summed over the workers, the depth buffer is cleared when a renderer is created so its first frame counts as well
+		DepthBuffer::Stats depthStats{};
+		RenderStats renderStats{};
+		//wall time of the whole run, including the setup of the worker renderers and writing the last frames
+		double seconds{};
+
+		double GetFPS() const noexcept { return seconds > 0. ? frameCount / seconds : 0.; }
+	};
+
+	//Renders many viewpoints of one mesh without a window
+	//Frames are distributed over worker threads that each own a headless renderer, the mesh is shared by all of them
+	class BatchRenderer final
+	{
+	public:
+		explicit BatchRenderer(std::shared_ptr<MeshData const> pMesh);
+		~BatchRenderer() = default;
+
+		BatchRenderer(const BatchRenderer&) = delete;
+		BatchRenderer(BatchRenderer&&) noexcept = delete;
+		BatchRenderer& operator=(const BatchRenderer&) = delete;
+		BatchRenderer& operator=(BatchRenderer&&) noexcept = delete;
+
+		//Renders one frame per pose, frame i is written for poses[i] whatever thread rendered it
+		BatchResult Render(std::vector<CameraPose> const& poses, BatchSettings const& settings) const;
+
+		//One pose per line: "originX originY originZ targetX targetY targetZ", empty lines and lines starting with # are skipped
+		static std::vector<CameraPose> LoadPoses(std::filesystem::path const& path);
+		//Catmull-Rom spline through the control poses, sampled at frameCount evenly spaced points from the first to the last pose
+		static std::vector<CameraPose> SamplePath(std::vector<CameraPose> const& controlPoses, uint32_t frameCount);
+		//Full orbit around the sphere, slightly from above and far enough to keep it on screen
+		static std::vector<CameraPose> Turntable(BoundingSphere const& bounds, float fovAngle, uint32_t frameCount);
+
+		//Square grid on the ground plane, the copies a bit more than the mesh's diameter apart
+		//every copy is turned around its own center and tinted, the grid is centered on the mesh
+		static std::vector<Instance> CreateInstanceGrid(BoundingSphere const& bounds, uint32_t count);
+		//Sphere around every instance of a mesh with these bounds, the bounds themselves without instances
+		static BoundingSphere GetInstanceBounds(BoundingSphere const& bounds, std::vector<Instance> const& instances);
+
+	private:
+		std::shared_ptr<MeshData const> m_pMesh{ nullptr };
+	};
+}
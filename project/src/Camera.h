@@ -35,11 +35,16 @@ namespace dae
 
 		float nearPlane{ 0.1f };
 		float farPlane{ 100.f };
+		//projects the near plane to depth 1 and the far plane to 0, set by the renderer for reversed depth buffers
+		bool isDepthReversed{ false };
 
 		Matrix invViewMatrix{};
 		Matrix viewMatrix{};
 		Matrix projectionMatrix{};
 
+		//set whenever a matrix is recalculated, cleared by the renderer once it used them
+		bool isDirty{ true };
+
 		void Initialize(float _fovAngle = 90.f, Vector3 const& _origin = {0.f,0.f,0.f}, float _aspectRatio = 19.f / 6.f)
 		{
 			fovAngle = _fovAngle;
@@ -49,6 +54,7 @@ namespace dae
 
 			aspectRatio = _aspectRatio;
 
+			CalculateViewMatrix();
 			CalculateProjectionMatrix();
 		}
 
@@ -62,6 +68,7 @@ namespace dae
 
 			aspectRatio = _aspectRatio;
 
+			CalculateViewMatrix();
 			CalculateProjectionMatrix();
 		}
 
@@ -79,25 +86,37 @@ namespace dae
 		void UpdateOrigin(Vector3 const& pos)
 		{
 			origin = pos;
+			CalculateViewMatrix();
+		}
+		//Places the camera at pos looking at target, target can't be straight above or below pos
+		void LookAt(Vector3 const& pos, Vector3 const& target)
+		{
+			origin = pos;
+			forward = (target - pos).Normalized();
+			CalculateViewMatrix();
 		}
 	#pragma endregion
 
 		void CalculateViewMatrix()
 		{
-			right = Vector3::Cross(Vector3::UnitY, forward);
+			//normalized, otherwise a pitched forward scales the view
+			right = Vector3::Cross(Vector3::UnitY, forward).Normalized();
 			up = Vector3::Cross(forward, right);
 
 			invViewMatrix = { right, up, forward, origin };
 			viewMatrix = Matrix::Inverse(invViewMatrix);
+			isDirty = true;
 
 
-			//ViewMatrix => Matrix::CreateLookAtLH(...) [not implemented yet]
+			//ViewMatrix => Matrix::CreateLookAtLH(origin, forward, Vector3::UnitY) is the same matrix, it differs from the inverse in the last bits
 			//DirectX Implementation => https://learn.microsoft.com/en-us/windows/win32/direct3d9/d3dxmatrixlookatlh
 		}
 
 		void CalculateProjectionMatrix()
 		{
-			projectionMatrix = Matrix::CreatePerspectiveFovLH(fov, aspectRatio, nearPlane, farPlane);
+			projectionMatrix = isDepthReversed ? Matrix::CreatePerspectiveFovLHReversedZ(fov, aspectRatio, nearPlane, farPlane)
+				: Matrix::CreatePerspectiveFovLH(fov, aspectRatio, nearPlane, farPlane);
+			isDirty = true;
 			//DirectX Implementation => https://learn.microsoft.com/en-us/windows/win32/direct3d9/d3dxmatrixperspectivefovlh
 		}
 
@@ -109,6 +128,7 @@ namespace dae
 			uint8_t const* pKeyboardState{ SDL_GetKeyboardState(nullptr) };
 			
 			Vector3 movementDir{ };
+			bool hasMoved{ false };
 
 			if (pKeyboardState[SDL_SCANCODE_W] || pKeyboardState[SDL_SCANCODE_UP])
 				movementDir += forward;
@@ -123,6 +143,7 @@ namespace dae
 			{
 				movementDir.Normalize();
 				origin += (movementDir * movementSpeed * deltaTime);
+				hasMoved = true;
 			}
 
 			//Mouse Input
@@ -135,6 +156,7 @@ namespace dae
 			{
 				origin += forward * (-mouseY * movementSpeed * deltaTime);
 				forward = Matrix::CreateRotationY(mouseX * rotationSpeed * deltaTime).TransformVector(forward);
+				hasMoved = hasMoved || mouseX != 0 || mouseY != 0;
 			}
 
 			// RMB
@@ -142,13 +164,15 @@ namespace dae
 			{
 				forward = Matrix::CreateRotationY(mouseX * rotationSpeed * deltaTime).TransformVector(forward);
 				forward = Matrix::CreateRotationX(-mouseY * rotationSpeed * deltaTime).TransformVector(forward);
+				hasMoved = hasMoved || mouseX != 0 || mouseY != 0;
 			}
 
 			//TODO move world Up/Down
 
 
-			//Update Matrices
-			CalculateViewMatrix();
+			//Update Matrices - a still camera keeps its matrices so the renderer can reuse its work
+			if (hasMoved)
+				CalculateViewMatrix();
 		}
 	};
 }
@@ -3,6 +3,7 @@
 #include "Texture.h"
 #include "vector"
 #include <memory>
+#include <algorithm>
 
 namespace dae
 {
@@ -36,13 +37,67 @@ namespace dae
 			position{ p } {}
 	};
 
+	struct AABB
+	{
+		Vector3 min{ FLT_MAX, FLT_MAX, FLT_MAX };
+		Vector3 max{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		void Grow(Vector3 const& p) noexcept
+		{
+			min = { std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z) };
+			max = { std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z) };
+		}
+	};
+
+	struct BoundingSphere
+	{
+		Vector3 center{};
+		float radius{};
+	};
+
+	//Small cluster of triangles that is culled as a whole, see MeshOptimizer::BuildMeshlets
+	struct Meshlet
+	{
+		//range in MeshData::meshletVertices, the unique vertices used by this meshlet
+		uint32_t vertexOffset{};
+		uint32_t vertexCount{};
+		//range in MeshData::indices, triangles of a meshlet are stored contiguously
+		uint32_t indexOffset{};
+		uint32_t triangleCount{};
+
+		//local space
+		BoundingSphere bounds{};
+		//normal cone (average face normal and sin of the spread angle), cutoff >= 1 means the cone can't be used to cull
+		Vector3 coneAxis{};
+		float coneCutoff{ 1.f };
+	};
+
+	//Simplified version of a mesh, shares the vertices of its MeshData
+	struct MeshLOD
+	{
+		std::vector<uint32_t> indices{};
+		//unique vertices referenced by the indices, only these are transformed
+		std::vector<uint32_t> vertices{};
+		//object space simplification error, projected to pixels to select a level
+		float error{};
+	};
+
+	//Per instance data of an instanced mesh
+	struct Instance
+	{
+		//applied after the world matrix of the mesh
+		Matrix worldMatrix{};
+		ColorRGB color{ colors::White };
+	};
+
 	enum class PrimitiveTopology
 	{
 		TriangleList,
 		TriangleStrip
 	};
 
-	struct Mesh
+	//Geometry and textures, immutable after loading and shared by every MeshInstance drawing it
+	struct MeshData
 	{
 		//textures
 		std::shared_ptr<Texture> pGloss{ nullptr };
@@ -54,21 +109,66 @@ namespace dae
 		std::vector<uint32_t> indices{};
 		PrimitiveTopology primitiveTopology{ PrimitiveTopology::TriangleStrip };
 
-		std::vector<Vertex_Out> vertices_out{};
+		//triangle clusters, only built for triangle lists
+		std::vector<Meshlet> meshlets{};
+		std::vector<uint32_t> meshletVertices{};
+
+		//coarser levels of detail, the mesh itself is level 0
+		std::vector<MeshLOD> lods{};
+
+		//local space bounds, calculated once after loading
+		AABB boundingBox{};
+		BoundingSphere boundingSphere{};
+
+		//Triangles drawn at a level of detail, 0 is the mesh itself
+		size_t GetTriangleCount(uint32_t lod = 0) const noexcept
+		{
+			if (lod > 0)
+				return lods[lod - 1].indices.size() / 3;
+
+			if (primitiveTopology == PrimitiveTopology::TriangleStrip)
+				return indices.size() > 2 ? indices.size() - 2 : 0;
+			return indices.size() / 3;
+		}
+
+		void CalculateBounds() noexcept
+		{
+			boundingBox = {};
+			for (auto const& v : vertices)
+				boundingBox.Grow(v.position);
+
+			//sphere around the box center, tighter than the box' circumscribed sphere
+			boundingSphere.center = (boundingBox.min + boundingBox.max) * .5f;
+			boundingSphere.radius = 0.f;
+			for (auto const& v : vertices)
+				boundingSphere.radius = std::max(boundingSphere.radius, (v.position - boundingSphere.center).Magnitude());
+		}
+	};
+
+	//Placement of shared MeshData in the scene, cheap to copy
+	struct MeshInstance
+	{
+		std::shared_ptr<MeshData const> pData{ nullptr };
 		Matrix worldMatrix{};
 
-		Mesh() = default;
-		~Mesh() = default;
+		//when not empty the mesh is drawn once per instance instead of once with worldMatrix
+		std::vector<Instance> instances{};
+
+		//set when the transform or instances changed, the renderer reuses the transformed vertices while it's cleared
+		//has to be set manually when writing worldMatrix or instances directly
+		bool isDirty{ true };
 
 		//translate the worldMatrix
 		void Translate(Vector3 const& t) noexcept
 		{
 			worldMatrix = Matrix::CreateTranslation(t.x, t.y, t.z) * worldMatrix;
+			isDirty = true;
 		}
 
 		void RotateY(float r)
 		{
 			worldMatrix = worldMatrix * Matrix::CreateRotationY(r);
+			isDirty = true;
 		}
 	};
 }
@@ -0,0 +1,115 @@
+#include "DepthBuffer.h"
+
+#include <algorithm>
+
+namespace dae
+{
+	DepthBuffer::DepthBuffer(int width, int height, DepthFormat format, uint32_t sampleCount) :
+		m_Format{ format },
+		m_SampleCount{ std::max(sampleCount, 1u) }
+	{
+		size_t const pixelCount{ static_cast<size_t>(width) * height };
+		switch (m_Format)
+		{
+		case DepthFormat::Unorm16:
+			m_Unorm16.resize(pixelCount * m_SampleCount);
+			break;
+		case DepthFormat::Fixed24:
+			m_Fixed24.resize(pixelCount * m_SampleCount);
+			break;
+		default:
+			m_Float32.resize(pixelCount * m_SampleCount);
+			break;
+		}
+
+		Clear(0, static_cast<int>(pixelCount));
+		ResetStats();
+	}
+
+	size_t DepthBuffer::GetMemoryBytes() const noexcept
+	{
+		return m_Float32.size() * sizeof(float) + m_Unorm16.size() * sizeof(uint16_t) + m_Fixed24.size() * sizeof(uint32_t);
+	}
+
+	size_t DepthBuffer::GetBytesPerPixel(DepthFormat format) noexcept
+	{
+		return format == DepthFormat::Unorm16 ? sizeof(uint16_t) : sizeof(uint32_t);
+	}
+
+	char const* DepthBuffer::GetName(DepthFormat format) noexcept
+	{
+		switch (format)
+		{
+		case DepthFormat::Float32:
+			return "Float32";
+		case DepthFormat::ReversedFloat32:
+			return "ReversedFloat32";
+		case DepthFormat::Unorm16:
+			return "Unorm16";
+		case DepthFormat::Fixed24:
+			return "Fixed24";
+		default:
+			return "Unknown";
+		}
+	}
+
+	void DepthBuffer::Clear(int firstPixel, int pixelCount)
+	{
+		size_t const firstSample{ static_cast<size_t>(firstPixel) * m_SampleCount };
+		size_t const sampleCount{ static_cast<size_t>(pixelCount) * m_SampleCount };
+		m_Stats.clearedPixels += sampleCount;
+
+		switch (m_Format)
+		{
+		case DepthFormat::ReversedFloat32:
+			std::fill_n(&m_Float32[firstSample], sampleCount, ClearReversedFloat32);
+			break;
+		case DepthFormat::Unorm16:
+			std::fill_n(&m_Unorm16[firstSample], sampleCount, ClearUnorm16);
+			break;
+		case DepthFormat::Fixed24:
+			std::fill_n(&m_Fixed24[firstSample], sampleCount, ClearFixed24);
+			break;
+		case DepthFormat::Float32:
+		default:
+			std::fill_n(&m_Float32[firstSample], sampleCount, ClearFloat32);
+			break;
+		}
+	}
+
+	void DepthBuffer::Decode(int firstPixel, int pixelCount, float* pDepths) const
+	{
+		//Farthest of the samples of every pixel
+		auto const decode{ [&](auto const* pSamples, auto const& toDepth)
+		{
+			pSamples += static_cast<size_t>(firstPixel) * m_SampleCount;
+			for (int pixel{ 0 }; pixel < pixelCount; ++pixel, pSamples += m_SampleCount)
+			{
+				float depth{ toDepth(pSamples[0]) };
+				for (uint32_t s{ 1 }; s < m_SampleCount; ++s)
+					depth = std::max(depth, toDepth(pSamples[s]));
+				pDepths[pixel] = depth;
+			}
+		} };
+
+		switch (m_Format)
+		{
+		case DepthFormat::ReversedFloat32:
+			decode(m_Float32.data(), [](float d) { return 1.f - d; });
+			break;
+		case DepthFormat::Unorm16:
+			decode(m_Unorm16.data(), [](uint16_t d) { return d / 65535.f; });
+			break;
+		case DepthFormat::Fixed24:
+			decode(m_Fixed24.data(), [](uint32_t d) { return d / 16777215.f; });
+			break;
+		case DepthFormat::Float32:
+		default:
+			if (m_SampleCount == 1)
+				std::copy_n(&m_Float32[firstPixel], pixelCount, pDepths);
+			else
+				decode(m_Float32.data(), [](float d) { return d; });
+			break;
+		}
+	}
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dae
+{
+	enum class DepthFormat : uint8_t
+	{
+		//0 at the near plane to 1 at the far plane
+		Float32,
+		//1 at the near plane to 0 at the far plane, the precision of floats near 0 evens out the hyperbolic distribution of depth
+		ReversedFloat32,
+		//half the memory traffic, enough when the far / near ratio of the scene is modest
+		Unorm16,
+		//24 bit fixed point stored in 32 bits, a D24 layout without stencil
+		Fixed24,
+		Count
+	};
+
+	//Per sample depth in one of the DepthFormats, tests and writes in a single step
+	//One sample per pixel unless multisampled, the samples of a pixel are stored next to each other
+	class DepthBuffer final
+	{
+	public:
+		//Counted per sample when multisampled
+		struct Stats
+		{
+			uint64_t tests{};
+			uint64_t writes{};
+			//fragments with the same stored depth as the fragment already there, the source of depth fighting
+			uint64_t ties{};
+			uint64_t clearedPixels{};
+			//writes to samples that still held the clear depth, the samples covered by geometry
+			uint64_t firstWrites{};
+
+			//reads for every test, writes for every passed test and clear
+			uint64_t GetBytes(size_t bytesPerSample) const noexcept { return (tests + writes + clearedPixels) * bytesPerSample; }
+			float GetTieRate() const noexcept { return tests ? static_cast<float>(ties) / tests : 0.f; }
+
+			Stats& operator+=(Stats const& other) noexcept
+			{
+				tests += other.tests;
+				writes += other.writes;
+				ties += other.ties;
+				clearedPixels += other.clearedPixels;
+				firstWrites += other.firstWrites;
+				return *this;
+			}
+		};
+
+		DepthBuffer() = default;
+		DepthBuffer(int width, int height, DepthFormat format = DepthFormat::Float32, uint32_t sampleCount = 1);
+
+		DepthFormat GetFormat() const noexcept { return m_Format; }
+		uint32_t GetSampleCount() const noexcept { return m_SampleCount; }
+		//The projection has to map the near plane to 1 and the far plane to 0
+		bool IsReversed() const noexcept { return m_Format == DepthFormat::ReversedFloat32; }
+		size_t GetBytesPerPixel() const noexcept { return GetBytesPerPixel(m_Format) * m_SampleCount; }
+		//Allocated for every sample
+		size_t GetMemoryBytes() const noexcept;
+
+		//Of a single sample
+		static size_t GetBytesPerPixel(DepthFormat format) noexcept;
+		static char const* GetName(DepthFormat format) noexcept;
+
+		Stats const& GetStats() const noexcept { return m_Stats; }
+		void ResetStats() noexcept { m_Stats = {}; }
+
+		//Sets every sample of the pixels to the far plane
+		void Clear(int firstPixel, int pixelCount);
+
+		//Depth of the fragment in the range of the projection, stores it and returns true when it's not behind the stored depth
+		//sample is pixel * sample count + the sample within the pixel, the pixel itself without multisampling
+		bool TestAndWrite(int sample, float depth) noexcept
+		{
+			++m_Stats.tests;
+
+			switch (m_Format)
+			{
+			case DepthFormat::ReversedFloat32:
+				return TestAndWrite(m_Float32[sample], depth, ClearReversedFloat32, true);
+			case DepthFormat::Unorm16:
+				return TestAndWrite(m_Unorm16[sample], static_cast<uint16_t>(depth * 65535.f + .5f), ClearUnorm16, false);
+			case DepthFormat::Fixed24:
+				return TestAndWrite(m_Fixed24[sample], static_cast<uint32_t>(depth * 16777215.f + .5f), ClearFixed24, false);
+			case DepthFormat::Float32:
+			default:
+				return TestAndWrite(m_Float32[sample], depth, ClearFloat32, false);
+			}
+		}
+
+		//Depth as 0 at the near to 1 at the far plane whatever the format, cleared Float32 pixels stay FLT_MAX
+		//The farthest sample of a multisampled pixel, conservative for occlusion tests
+		void Decode(int firstPixel, int pixelCount, float* pDepths) const;
+
+	private:
+		//Far plane of each format, a fragment exactly at the far plane of a quantized format counts as a first write again
+		static constexpr float ClearFloat32{ FLT_MAX };
+		static constexpr float ClearReversedFloat32{ 0.f };
+		static constexpr uint16_t ClearUnorm16{ 0xffff };
+		static constexpr uint32_t ClearFixed24{ 0xffffff };
+
+		DepthFormat m_Format{ DepthFormat::Float32 };
+		uint32_t m_SampleCount{ 1 };
+		//only the buffer of the format is allocated
+		std::vector<float> m_Float32{};
+		std::vector<uint16_t> m_Unorm16{};
+		std::vector<uint32_t> m_Fixed24{};
+		Stats m_Stats{};
+
+		template<typename T>
+		bool TestAndWrite(T& stored, T depth, T clearDepth, bool isReversed) noexcept
+		{
+			if (depth == stored)
+				++m_Stats.ties;
+
+			//equal depths pass, the last triangle drawn wins like before
+			if (isReversed ? stored > depth : stored < depth)
+				return false;
+
+			if (stored == clearDepth)
+				++m_Stats.firstWrites;
+
+			stored = depth;
+			++m_Stats.writes;
+			return true;
+		}
+	};
+}
@@ -0,0 +1,78 @@
+#include "FrameTimeHistogram.h"
+
+//Standard includes
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace dae
+{
+	FrameTimeHistogram::FrameTimeHistogram()
+	{
+		m_Window.reserve(WindowSize);
+	}
+
+	void FrameTimeHistogram::Record(float milliseconds)
+	{
+		//anything past an hour is a paused process, not a frame worth a bucket of its own
+		float const microseconds{ std::clamp(milliseconds * 1000.f, 0.f, 3.6e9f) };
+		uint16_t const bucket{ static_cast<uint16_t>(GetBucket(static_cast<uint32_t>(std::lround(microseconds)))) };
+
+		if (m_Window.size() < WindowSize)
+		{
+			m_Window.emplace_back(bucket);
+			++m_Count;
+		}
+		else
+		{
+			--m_Counts[m_Window[m_Head]];
+			m_Window[m_Head] = bucket;
+			m_Head = (m_Head + 1) % WindowSize;
+		}
+
+		++m_Counts[bucket];
+	}
+
+	void FrameTimeHistogram::Clear()
+	{
+		m_Counts.fill(0);
+		m_Window.clear();
+		m_Head = 0;
+		m_Count = 0;
+	}
+
+	float FrameTimeHistogram::GetPercentile(float fraction) const noexcept
+	{
+		if (m_Count == 0)
+			return 0.f;
+
+		//Nearest rank, the smallest frame time that at least the given fraction of the frames doesn't exceed
+		uint32_t const rank{ std::clamp(static_cast<uint32_t>(std::ceil(fraction * m_Count)), 1u, m_Count) };
+
+		uint32_t seen{ 0 };
+		for (uint32_t bucket{ 0 }; bucket < BucketCount; ++bucket)
+		{
+			seen += m_Counts[bucket];
+			if (seen >= rank)
+				return GetBucketMiddle(bucket);
+		}
+
+		return GetBucketMiddle(BucketCount - 1);
+	}
+
+	uint32_t FrameTimeHistogram::GetBucket(uint32_t microseconds) noexcept
+	{
+		//the SubBucketBits + 1 highest bits select the bucket, the ones below are dropped
+		int const bitWidth{ static_cast<int>(std::bit_width(microseconds)) };
+		uint32_t const shift{ bitWidth > static_cast<int>(SubBucketBits) + 1 ? static_cast<uint32_t>(bitWidth) - SubBucketBits - 1 : 0u };
+		return (shift << SubBucketBits) + (microseconds >> shift);
+	}
+
+	float FrameTimeHistogram::GetBucketMiddle(uint32_t bucket) noexcept
+	{
+		uint32_t const shift{ bucket < 2 * SubBucketCount ? 0u : bucket / SubBucketCount - 1 };
+		uint32_t const lowest{ (bucket - (shift << SubBucketBits)) << shift };
+		float const width{ static_cast<float>(1u << shift) };
+		return (lowest + (width - 1.f) * .5f) / 1000.f;
+	}
+}
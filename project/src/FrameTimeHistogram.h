@@ -0,0 +1,44 @@
+#pragma once
+
+//Standard includes
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace dae
+{
+	//Frame times of the last WindowSize frames in log-linear buckets, the layout of an HdrHistogram
+	//Recording and evicting a frame is a single bucket update, a percentile query walks the buckets instead of sorting frames
+	class FrameTimeHistogram final
+	{
+	public:
+		static uint32_t constexpr WindowSize{ 4096 };
+
+		FrameTimeHistogram();
+
+		//Milliseconds, the oldest frame leaves the window once it is full
+		void Record(float milliseconds);
+		void Clear();
+
+		//Frames in the window
+		uint32_t GetCount() const noexcept { return m_Count; }
+		//Nearest rank over the window in milliseconds, the middle of the bucket holding it so within about 1.5% of the recorded time
+		float GetPercentile(float fraction) const noexcept;
+		float GetMax() const noexcept { return GetPercentile(1.f); }
+
+	private:
+		//Microseconds below SubBucketCount have a bucket each, every power of two above is split into SubBucketCount buckets
+		static uint32_t constexpr SubBucketBits{ 5 };
+		static uint32_t constexpr SubBucketCount{ 1u << SubBucketBits };
+		static uint32_t constexpr BucketCount{ (32 - SubBucketBits + 1) * SubBucketCount };
+
+		std::array<uint32_t, BucketCount> m_Counts{};
+		//bucket of every frame in the window, a ring starting at m_Head once full
+		std::vector<uint16_t> m_Window{};
+		uint32_t m_Head{ 0 };
+		uint32_t m_Count{ 0 };
+
+		static uint32_t GetBucket(uint32_t microseconds) noexcept;
+		static float GetBucketMiddle(uint32_t bucket) noexcept;
+	};
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "Maths.h"
+#include "DataTypes.h"
+
+namespace dae
+{
+	struct Plane
+	{
+		Vector3 normal{ Vector3::UnitZ };
+		float distance{};
+
+		Plane() = default;
+		Plane(Vector4 const& p)
+		{
+			//normalize so SignedDistance returns world units
+			float const invLength{ 1.f / Vector3{ p.x, p.y, p.z }.Magnitude() };
+			normal = Vector3{ p.x, p.y, p.z } * invLength;
+			distance = p.w * invLength;
+		}
+
+		[[nodiscard]] float SignedDistance(Vector3 const& p) const noexcept
+		{
+			return Vector3::Dot(normal, p) + distance;
+		}
+	};
+
+	struct Frustum
+	{
+		enum PlaneSide : uint8_t
+		{
+			Left,
+			Right,
+			Bottom,
+			Top,
+			Near,
+			Far,
+			Count
+		};
+		//Normals point inwards
+		Plane planes[PlaneSide::Count]{};
+
+		//Gribb/Hartmann plane extraction, matrices are row-major and applied to row vectors (v * M)
+		//Expects a DirectX style projection (0 <= z <= w)
+		[[nodiscard]] static Frustum FromMatrix(Matrix const& viewProjection)
+		{
+			auto const column{ [&viewProjection](int c)
+			{
+				return Vector4{ viewProjection[0][c], viewProjection[1][c], viewProjection[2][c], viewProjection[3][c] };
+			} };
+
+			Vector4 const c0{ column(0) };
+			Vector4 const c1{ column(1) };
+			Vector4 const c2{ column(2) };
+			Vector4 const c3{ column(3) };
+
+			Frustum frustum{};
+			frustum.planes[Left] = Plane{ c3 + c0 };
+			frustum.planes[Right] = Plane{ c3 - c0 };
+			frustum.planes[Bottom] = Plane{ c3 + c1 };
+			frustum.planes[Top] = Plane{ c3 - c1 };
+			//a reversed depth projection swaps these two, the frustum stays the same
+			frustum.planes[Near] = Plane{ c2 };
+			frustum.planes[Far] = Plane{ c3 - c2 };
+			return frustum;
+		}
+
+		//Sphere is given in local space and transformed by the world matrix (radius scaled by the largest axis)
+		[[nodiscard]] bool IsVisible(BoundingSphere const& sphere, Matrix const& worldMatrix) const noexcept
+		{
+			Vector3 const center{ worldMatrix.TransformPoint(sphere.center) };
+			float const maxScale{ std::max({ worldMatrix.GetAxisX().Magnitude(), worldMatrix.GetAxisY().Magnitude(), worldMatrix.GetAxisZ().Magnitude() }) };
+			float const radius{ sphere.radius * maxScale };
+
+			for (auto const& plane : planes)
+			{
+				if (plane.SignedDistance(center) < -radius)
+					return false;
+			}
+			return true;
+		}
+
+		//Box is given in local space, the transformed box is enclosed in a world space AABB before testing
+		[[nodiscard]] bool IsVisible(AABB const& box, Matrix const& worldMatrix) const noexcept
+		{
+			Vector3 const localCenter{ (box.min + box.max) * .5f };
+			Vector3 const localExtents{ (box.max - box.min) * .5f };
+
+			Vector3 const center{ worldMatrix.TransformPoint(localCenter) };
+			Vector3 extents{};
+			for (int c{ 0 }; c < 3; ++c)
+			{
+				extents[c] = std::abs(worldMatrix[0][c]) * localExtents.x
+						   + std::abs(worldMatrix[1][c]) * localExtents.y
+						   + std::abs(worldMatrix[2][c]) * localExtents.z;
+			}
+
+			for (auto const& plane : planes)
+			{
+				float const projectedRadius{ std::abs(plane.normal.x) * extents.x + std::abs(plane.normal.y) * extents.y + std::abs(plane.normal.z) * extents.z };
+				if (plane.SignedDistance(center) < -projectedRadius)
+					return false;
+			}
+			return true;
+		}
+	};
+}
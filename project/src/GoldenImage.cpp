@@ -0,0 +1,266 @@
+#include "GoldenImage.h"
+
+//External includes
+#include <SDL_image.h>
+
+//Standard includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <memory>
+
+//Project includes
+#include "BatchRenderer.h"
+#include "DataTypes.h"
+#include "RenderTarget.h"
+#include "Renderer.h"
+
+namespace dae
+{
+	namespace
+	{
+		//Same names as the --mode values of the batch renderer
+		char const* GetModeName(Renderer::ShadingMode mode) noexcept
+		{
+			switch (mode)
+			{
+			case Renderer::ShadingMode::ObservedArea:
+				return "observedarea";
+			case Renderer::ShadingMode::Diffuse:
+				return "diffuse";
+			case Renderer::ShadingMode::Specular:
+				return "specular";
+			case Renderer::ShadingMode::Combined:
+				return "combined";
+			case Renderer::ShadingMode::PhysicallyBased:
+				return "pbr";
+			default:
+				return "unknown";
+			}
+		}
+
+		//Square facing the camera of the turntable's first pose, uv 0 to 1 over the whole quad so the texture shows how uvs are interpolated
+		//the specular map varies over the quad as well, so the specular modes don't repeat the diffuse one
+		std::shared_ptr<MeshData const> CreateTexturedQuad(std::filesystem::path const& diffusePath, std::filesystem::path const& specularPath)
+		{
+			auto const pMesh{ Renderer::CreateGrid(10.f, 10.f, 1) };
+
+			pMesh->pDiffuse = std::make_shared<Texture>(diffusePath);
+			pMesh->pNormal = std::make_shared<Texture>(ColorRGB{ .5f, .5f, 1.f });
+			pMesh->pSpecular = std::make_shared<Texture>(specularPath);
+			pMesh->pGloss = std::make_shared<Texture>(ColorRGB{ .1f, .1f, .1f });
+			return pMesh;
+		}
+
+		uint8_t GetChannel(uint32_t pixel, uint32_t shift) noexcept
+		{
+			return static_cast<uint8_t>((pixel >> shift) & 0xff);
+		}
+	}
+
+	std::vector<GoldenResult> GoldenImage::Run(GoldenSettings const& settings)
+	{
+		struct Variant
+		{
+			Renderer::ShadingMode mode{};
+			uint32_t sampleCount{ 1 };
+		};
+
+		//Every shading mode, and the combined one once more with multisampling
+		std::vector<Variant> allVariants{};
+		for (uint8_t modeIdx{ 0 }; modeIdx < static_cast<uint8_t>(Renderer::ShadingMode::Count); ++modeIdx)
+			allVariants.push_back({ static_cast<Renderer::ShadingMode>(modeIdx) });
+		allVariants.push_back({ Renderer::ShadingMode::Combined, 4 });
+
+		//Without a specular map the specular mode is black and combined is the diffuse mode again
+		std::vector<Variant> withoutSpecularVariants{};
+		std::copy_if(allVariants.begin(), allVariants.end(), std::back_inserter(withoutSpecularVariants), [](Variant const& variant)
+			{
+				return variant.sampleCount > 1 || (variant.mode != Renderer::ShadingMode::Specular && variant.mode != Renderer::ShadingMode::Combined);
+			});
+
+		struct Scene
+		{
+			std::string name{};
+			std::shared_ptr<MeshData const> pMesh{ nullptr };
+			std::vector<Variant> variants{};
+			//drawn through the instanced path when not empty, the instances are placed after the world matrix
+			Matrix worldMatrix{};
+			std::vector<Instance> instances{};
+		};
+
+		auto const pQuad{ CreateTexturedQuad("resources/uv_grid.png", "resources/uv_grid_2.png") };
+
+		std::vector<Scene> const scenes
+		{
+			{ "vehicle", Renderer::LoadMesh("vehicle"), allVariants },
+			{ "tuktuk", Renderer::LoadMesh("tuktuk"), withoutSpecularVariants },
+			{ "uv_grid", pQuad, allVariants },
+			//2x2 tinted quads, each turned by its own rotation and the mesh's, a swapped matrix order turns the whole grid instead
+			//placement and tint are checked, one mode is enough
+			{ "uv_grid_instanced", pQuad, { { Renderer::ShadingMode::Combined } }, Matrix::CreateRotationY(-30.f * TO_RADIANS), BatchRenderer::CreateInstanceGrid(pQuad->boundingSphere, 4) }
+		};
+
+		std::filesystem::create_directories(settings.isUpdating ? settings.referenceDirectory : settings.diffDirectory);
+
+		std::vector<GoldenResult> results{};
+		for (auto const& scene : scenes)
+		{
+			Renderer renderer{ settings.width, settings.height, scene.pMesh };
+			renderer.SetWorldMatrix(0, scene.worldMatrix);
+			renderer.SetInstances(0, scene.instances);
+
+			//Second pose of the turntable, the mesh seen from the front-left and slightly above
+			BoundingSphere const meshBounds{ scene.worldMatrix.TransformPoint(scene.pMesh->boundingSphere.center), scene.pMesh->boundingSphere.radius };
+			BoundingSphere const bounds{ BatchRenderer::GetInstanceBounds(meshBounds, scene.instances) };
+			Camera& camera{ renderer.GetCamera() };
+			CameraPose const pose{ BatchRenderer::Turntable(bounds, camera.fovAngle, 8)[1] };
+			camera.farPlane = std::max(camera.farPlane, (bounds.center - pose.origin).Magnitude() + bounds.radius);
+			camera.CalculateProjectionMatrix();
+			camera.LookAt(pose.origin, pose.target);
+
+			for (Variant const& variant : scene.variants)
+			{
+				renderer.SetShadingMode(variant.mode);
+				renderer.SetSampleCount(variant.sampleCount);
+				//a dirty camera makes the renderer draw the frame instead of presenting the previous one again
+				camera.isDirty = true;
+				renderer.Render();
+
+				RenderTarget const& target{ renderer.GetRenderTarget() };
+				std::string name{ scene.name + "_" + GetModeName(variant.mode) };
+				if (variant.sampleCount > 1)
+					name += "_msaa" + std::to_string(variant.sampleCount);
+				std::filesystem::path const referencePath{ settings.referenceDirectory / (name + ".png") };
+
+				if (settings.isUpdating)
+				{
+					GoldenResult result{};
+					result.name = name;
+					result.hasReference = true;
+					result.isPassed = Write(referencePath, target.GetWidth(), target.GetHeight(), target.GetPixels());
+					results.emplace_back(result);
+					continue;
+				}
+
+				std::vector<uint32_t> const image{ target.GetPixels(), target.GetPixels() + static_cast<size_t>(target.GetWidth()) * target.GetHeight() };
+				std::vector<uint32_t> reference{};
+
+				GoldenResult result{};
+				if (Load(referencePath, target.GetWidth(), target.GetHeight(), reference))
+					result = Compare(image, reference, settings);
+				result.name = name;
+
+				//what was rendered is kept next to the diff, it can be inspected and copied over the reference when the change is intended
+				if (!result.isPassed)
+				{
+					Write(settings.diffDirectory / (name + ".png"), target.GetWidth(), target.GetHeight(), image.data());
+					if (result.hasReference)
+						Write(settings.diffDirectory / (name + "_diff.png"), target.GetWidth(), target.GetHeight(), CreateDiff(image, reference, settings.tolerance).data());
+				}
+
+				results.emplace_back(result);
+			}
+		}
+
+		return results;
+	}
+
+	GoldenResult GoldenImage::Compare(std::vector<uint32_t> const& image, std::vector<uint32_t> const& reference, GoldenSettings const& settings)
+	{
+		GoldenResult result{};
+		result.hasReference = image.size() == reference.size();
+		if (!result.hasReference || image.empty())
+			return result;
+
+		uint64_t squaredError{};
+		for (size_t i{ 0 }; i < image.size(); ++i)
+		{
+			uint8_t pixelDifference{};
+			for (uint32_t shift{ 0 }; shift < 24; shift += 8)
+			{
+				int const difference{ std::abs(GetChannel(image[i], shift) - GetChannel(reference[i], shift)) };
+				squaredError += static_cast<uint64_t>(difference * difference);
+				pixelDifference = std::max(pixelDifference, static_cast<uint8_t>(difference));
+			}
+
+			result.maxDifference = std::max(result.maxDifference, pixelDifference);
+			if (pixelDifference > settings.tolerance)
+				++result.mismatchedPixels;
+		}
+
+		double const meanSquaredError{ static_cast<double>(squaredError) / (image.size() * 3) };
+		result.psnr = meanSquaredError > 0. ? 10. * std::log10(255. * 255. / meanSquaredError) : std::numeric_limits<double>::infinity();
+
+		result.isPassed = result.psnr >= settings.minPSNR
+			&& result.mismatchedPixels <= static_cast<uint32_t>(settings.maxMismatchRatio * image.size());
+		return result;
+	}
+
+	bool GoldenImage::Load(std::filesystem::path const& path, int width, int height, std::vector<uint32_t>& pixels)
+	{
+		if (!std::filesystem::exists(path))
+			return false;
+
+		SDL_Surface* pLoaded{ IMG_Load(path.string().c_str()) };
+		if (!pLoaded)
+			return false;
+
+		//whatever format the PNG was stored in, compared as the pixels the renderer writes
+		SDL_Surface* pSurface{ SDL_ConvertSurfaceFormat(pLoaded, SDL_PIXELFORMAT_ARGB8888, 0) };
+		SDL_FreeSurface(pLoaded);
+		if (!pSurface)
+			return false;
+
+		bool const isMatchingSize{ pSurface->w == width && pSurface->h == height };
+		if (isMatchingSize)
+		{
+			pixels.resize(static_cast<size_t>(width) * height);
+			for (int y{ 0 }; y < height; ++y)
+			{
+				uint32_t const* pRow{ reinterpret_cast<uint32_t const*>(static_cast<uint8_t const*>(pSurface->pixels) + static_cast<size_t>(y) * pSurface->pitch) };
+				std::copy(pRow, pRow + width, pixels.begin() + static_cast<size_t>(y) * width);
+			}
+		}
+
+		SDL_FreeSurface(pSurface);
+		return isMatchingSize;
+	}
+
+	bool GoldenImage::Write(std::filesystem::path const& path, int width, int height, uint32_t const* pPixels)
+	{
+		SDL_Surface* pSurface{ SDL_CreateRGBSurfaceWithFormatFrom(const_cast<uint32_t*>(pPixels), width, height, 32,
+			width * static_cast<int>(sizeof(uint32_t)), SDL_PIXELFORMAT_ARGB8888) };
+		if (!pSurface)
+			return false;
+
+		int const result{ IMG_SavePNG(pSurface, path.string().c_str()) };
+
+		SDL_FreeSurface(pSurface);
+		return result == 0;
+	}
+
+	std::vector<uint32_t> GoldenImage::CreateDiff(std::vector<uint32_t> const& image, std::vector<uint32_t> const& reference, uint8_t tolerance)
+	{
+		std::vector<uint32_t> diff(image.size());
+		for (size_t i{ 0 }; i < image.size(); ++i)
+		{
+			uint8_t pixelDifference{};
+			for (uint32_t shift{ 0 }; shift < 24; shift += 8)
+				pixelDifference = std::max(pixelDifference, static_cast<uint8_t>(std::abs(GetChannel(image[i], shift) - GetChannel(reference[i], shift))));
+
+			if (pixelDifference > tolerance)
+			{
+				diff[i] = 0xffff0000;
+				continue;
+			}
+
+			uint32_t const gray{ (GetChannel(reference[i], 16) + GetChannel(reference[i], 8) + GetChannel(reference[i], 0)) / 12u };
+			diff[i] = 0xff000000 | gray << 16 | gray << 8 | gray;
+		}
+
+		return diff;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace dae
+{
+	struct GoldenSettings
+	{
+		//references are only valid for the resolution they were rendered at
+		int width{ 320 };
+		int height{ 240 };
+
+		//<scene>_<mode>.png per scene and shading mode, <scene>_<mode>_msaa<samples>.png when multisampled
+		std::filesystem::path referenceDirectory{ "golden" };
+		//rendered images and diffs of the comparisons that failed
+		std::filesystem::path diffDirectory{ "golden_diff" };
+		//writes the rendered images as the new references instead of comparing
+		bool isUpdating{ false };
+
+		//largest difference of a color channel (0-255) a pixel may have and still match
+		uint8_t tolerance{ 8 };
+		//fraction of the pixels allowed beyond the tolerance
+		//another compiler or contracted multiply-adds move edges by a pixel and flip coplanar parts of the meshes, just under a percent
+		double maxMismatchRatio{ .01 };
+		//peak signal-to-noise ratio of the whole image in dB, catches small differences spread over every pixel
+		double minPSNR{ 30. };
+	};
+
+	struct GoldenResult
+	{
+		//<scene>_<mode>, with _msaa<samples> when multisampled
+		std::string name{};
+		bool hasReference{ false };
+		bool isPassed{ false };
+
+		uint8_t maxDifference{};
+		uint32_t mismatchedPixels{};
+		//infinite when the images are identical
+		double psnr{};
+	};
+
+	//Renders fixed scenes headless in every shading mode and compares them against stored reference images
+	//Guards optimizations of the render paths, they should not change what ends up on screen
+	class GoldenImage final
+	{
+	public:
+		//vehicle, tuktuk and uv_grid (a textured quad) seen from the same angle, in every shading mode and combined with 4x multisampling
+		//tuktuk has no specular map and skips the specular and combined modes, they would repeat what the others show
+		//uv_grid_instanced draws tinted copies of the quad through the instanced path, combined only
+		static std::vector<GoldenResult> Run(GoldenSettings const& settings);
+
+		//Compares two ARGB8888 images of the same size, only the color channels count
+		static GoldenResult Compare(std::vector<uint32_t> const& image, std::vector<uint32_t> const& reference, GoldenSettings const& settings);
+
+	private:
+		static bool Load(std::filesystem::path const& path, int width, int height, std::vector<uint32_t>& pixels);
+		static bool Write(std::filesystem::path const& path, int width, int height, uint32_t const* pPixels);
+		//Reference dimmed to gray, the pixels beyond the tolerance in red
+		static std::vector<uint32_t> CreateDiff(std::vector<uint32_t> const& image, std::vector<uint32_t> const& reference, uint8_t tolerance);
+	};
+}
@@ -0,0 +1,298 @@
+#include "ImageWriter.h"
+
+//External includes
+#include "SDL.h"
+#include "SDL_surface.h"
+#include "SDL_image.h"
+
+//Standard includes
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+//Project includes
+#include "Profiler.h"
+#include "RenderTarget.h"
+
+namespace dae
+{
+	ImageWriter::ImageWriter(uint32_t threadCount, uint32_t maxQueuedFrames) :
+		m_MaxQueuedFrames{ std::max(maxQueuedFrames, 1u) }
+	{
+		threadCount = std::max(threadCount, 1u);
+
+		m_Threads.reserve(threadCount);
+		for (uint32_t i{ 0 }; i < threadCount; ++i)
+			m_Threads.emplace_back(&ImageWriter::Run, this);
+	}
+
+	ImageWriter::~ImageWriter()
+	{
+		{
+			std::lock_guard const lock{ m_Mutex };
+			m_IsStopping = true;
+		}
+		m_FrameQueued.notify_all();
+
+		for (auto& thread : m_Threads)
+			thread.join();
+	}
+
+	void ImageWriter::Submit(RenderTarget const& target, std::filesystem::path path)
+	{
+		ImageFormat const format{ GetFormat(path) };
+		Submit(target, std::move(path), format);
+	}
+
+	void ImageWriter::Submit(RenderTarget const& target, std::filesystem::path path, ImageFormat format)
+	{
+		Frame frame{};
+		frame.width = target.GetWidth();
+		frame.height = target.GetHeight();
+		frame.path = std::move(path);
+		frame.format = format;
+
+		{
+			std::unique_lock lock{ m_Mutex };
+
+			//Backpressure, the caller waits for the writer instead of queuing frames without bound
+			m_FrameDone.wait(lock, [this]() { return m_QueuedFrames < m_MaxQueuedFrames; });
+			++m_QueuedFrames;
+			++m_PendingFrames;
+
+			if (!m_FreeBuffers.empty())
+			{
+				frame.pixels = std::move(m_FreeBuffers.back());
+				m_FreeBuffers.pop_back();
+			}
+		}
+
+		//Copy outside of the lock, the writer threads keep encoding meanwhile
+		uint32_t const* pPixels{ target.GetPixels() };
+		frame.pixels.assign(pPixels, pPixels + static_cast<size_t>(frame.width) * frame.height);
+
+		{
+			std::lock_guard const lock{ m_Mutex };
+			m_Queue.emplace_back(std::move(frame));
+		}
+		m_FrameQueued.notify_one();
+	}
+
+	uint32_t ImageWriter::Flush()
+	{
+		std::unique_lock lock{ m_Mutex };
+		m_FrameDone.wait(lock, [this]() { return m_PendingFrames == 0; });
+		return m_FailedWrites;
+	}
+
+	std::filesystem::path ImageWriter::GetSequencePath(std::filesystem::path const& directory, uint32_t frame, ImageFormat format)
+	{
+		char name[32]{};
+		std::snprintf(name, sizeof(name), "frame_%05u%s", frame, GetExtension(format));
+		return directory / name;
+	}
+
+	char const* ImageWriter::GetExtension(ImageFormat format) noexcept
+	{
+		switch (format)
+		{
+		case ImageFormat::PNG:
+			return ".png";
+		case ImageFormat::QOI:
+			return ".qoi";
+		case ImageFormat::Raw:
+			return ".raw";
+		case ImageFormat::BMP:
+		default:
+			return ".bmp";
+		}
+	}
+
+	ImageFormat ImageWriter::GetFormat(std::filesystem::path const& path)
+	{
+		std::string extension{ path.extension().string() };
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+
+		if (extension == ".png")
+			return ImageFormat::PNG;
+		if (extension == ".qoi")
+			return ImageFormat::QOI;
+		if (extension == ".raw")
+			return ImageFormat::Raw;
+		return ImageFormat::BMP;
+	}
+
+	void ImageWriter::Run()
+	{
+		Profiler::SetThreadName("Image Writer");
+
+		while (true)
+		{
+			Frame frame{};
+			{
+				std::unique_lock lock{ m_Mutex };
+				m_FrameQueued.wait(lock, [this]() { return m_IsStopping || !m_Queue.empty(); });
+
+				//Only stops once the queue is drained, no submitted frame is dropped
+				if (m_Queue.empty())
+					return;
+
+				frame = std::move(m_Queue.front());
+				m_Queue.pop_front();
+				--m_QueuedFrames;
+			}
+			m_FrameDone.notify_all();
+
+			bool isWritten{};
+			{
+				PROFILE_SCOPE("Encode");
+				isWritten = Write(frame);
+			}
+			if (!isWritten)
+				std::cout << "Failed to write " << frame.path.string() << std::endl;
+
+			{
+				std::lock_guard const lock{ m_Mutex };
+				if (!isWritten)
+					++m_FailedWrites;
+
+				--m_PendingFrames;
+				m_FreeBuffers.emplace_back(std::move(frame.pixels));
+			}
+			m_FrameDone.notify_all();
+		}
+	}
+
+	bool ImageWriter::Write(Frame const& frame)
+	{
+		switch (frame.format)
+		{
+		case ImageFormat::QOI:
+			return WriteQOI(frame);
+		case ImageFormat::Raw:
+			return WriteRaw(frame);
+		default:
+			break;
+		}
+
+		//SDL doesn't write through the surface, the cast only satisfies the signature
+		SDL_Surface* pSurface{ SDL_CreateRGBSurfaceWithFormatFrom(const_cast<uint32_t*>(frame.pixels.data()), frame.width, frame.height, 32,
+			frame.width * static_cast<int>(sizeof(uint32_t)), SDL_PIXELFORMAT_ARGB8888) };
+		if (!pSurface)
+			return false;
+
+		std::string const path{ frame.path.string() };
+		int const result{ frame.format == ImageFormat::PNG ? IMG_SavePNG(pSurface, path.c_str()) : SDL_SaveBMP(pSurface, path.c_str()) };
+
+		SDL_FreeSurface(pSurface);
+		return result == 0;
+	}
+
+	bool ImageWriter::WriteQOI(Frame const& frame)
+	{
+		//Encoder of https://qoiformat.org/qoi-specification.pdf, written as RGB since the alpha is always opaque
+		uint8_t constexpr OpIndex{ 0x00 };
+		uint8_t constexpr OpDiff{ 0x40 };
+		uint8_t constexpr OpLuma{ 0x80 };
+		uint8_t constexpr OpRun{ 0xc0 };
+		uint8_t constexpr OpRGB{ 0xfe };
+		uint32_t constexpr MaxRun{ 62 };
+
+		std::vector<uint8_t> bytes{};
+		//header, worst case of 4 bytes per pixel and the end marker
+		bytes.reserve(14 + frame.pixels.size() * 4 + 8);
+
+		auto const pushBigEndian{ [&bytes](uint32_t v)
+		{
+			bytes.insert(bytes.end(), { static_cast<uint8_t>(v >> 24), static_cast<uint8_t>(v >> 16), static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v) });
+		} };
+
+		bytes.insert(bytes.end(), { 'q', 'o', 'i', 'f' });
+		pushBigEndian(static_cast<uint32_t>(frame.width));
+		pushBigEndian(static_cast<uint32_t>(frame.height));
+		//channels, sRGB color space
+		bytes.insert(bytes.end(), { 3, 0 });
+
+		//previously seen colors as ARGB, indexed by the hash of the spec
+		std::array<uint32_t, 64> seen{};
+		uint32_t previous{ 0xff000000 };
+		uint32_t run{ 0 };
+
+		for (size_t i{ 0 }; i < frame.pixels.size(); ++i)
+		{
+			//the alpha is ignored, the frame has no transparency
+			uint32_t const pixel{ frame.pixels[i] | 0xff000000 };
+
+			if (pixel == previous)
+			{
+				++run;
+				if (run == MaxRun || i + 1 == frame.pixels.size())
+				{
+					bytes.emplace_back(static_cast<uint8_t>(OpRun | (run - 1)));
+					run = 0;
+				}
+				continue;
+			}
+
+			if (run > 0)
+			{
+				bytes.emplace_back(static_cast<uint8_t>(OpRun | (run - 1)));
+				run = 0;
+			}
+
+			uint8_t const r{ static_cast<uint8_t>(pixel >> 16) };
+			uint8_t const g{ static_cast<uint8_t>(pixel >> 8) };
+			uint8_t const b{ static_cast<uint8_t>(pixel) };
+
+			uint32_t const hash{ (r * 3u + g * 5u + b * 7u + 255u * 11u) % 64u };
+			if (seen[hash] == pixel)
+			{
+				bytes.emplace_back(static_cast<uint8_t>(OpIndex | hash));
+			}
+			else
+			{
+				seen[hash] = pixel;
+
+				//channel differences wrap around, like the decoder
+				int const dr{ static_cast<int8_t>(r - static_cast<uint8_t>(previous >> 16)) };
+				int const dg{ static_cast<int8_t>(g - static_cast<uint8_t>(previous >> 8)) };
+				int const db{ static_cast<int8_t>(b - static_cast<uint8_t>(previous)) };
+				int const drg{ dr - dg };
+				int const dbg{ db - dg };
+
+				if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+				{
+					bytes.emplace_back(static_cast<uint8_t>(OpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+				}
+				else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7)
+				{
+					bytes.emplace_back(static_cast<uint8_t>(OpLuma | (dg + 32)));
+					bytes.emplace_back(static_cast<uint8_t>((drg + 8) << 4 | (dbg + 8)));
+				}
+				else
+				{
+					bytes.insert(bytes.end(), { OpRGB, r, g, b });
+				}
+			}
+
+			previous = pixel;
+		}
+
+		bytes.insert(bytes.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+
+		std::ofstream file{ frame.path, std::ios::binary };
+		file.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+		return static_cast<bool>(file);
+	}
+
+	bool ImageWriter::WriteRaw(Frame const& frame)
+	{
+		std::ofstream file{ frame.path, std::ios::binary };
+		file.write(reinterpret_cast<char const*>(frame.pixels.data()), static_cast<std::streamsize>(frame.pixels.size() * sizeof(uint32_t)));
+		return static_cast<bool>(file);
+	}
+}
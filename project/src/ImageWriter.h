@@ -0,0 +1,89 @@
+#pragma once
+
+//Standard includes
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dae
+{
+	class RenderTarget;
+
+	enum class ImageFormat : uint8_t
+	{
+		BMP,
+		PNG,
+		//https://qoiformat.org, much faster to encode than PNG at a similar size for rendered frames
+		QOI,
+		//ARGB8888 pixels as they are stored in memory (B, G, R, A bytes), no header
+		Raw
+	};
+
+	//Writes frames on background threads so saving an image doesn't stall rendering
+	//Submitted frames are copied into pooled buffers, at most maxQueuedFrames wait to be encoded before Submit blocks
+	class ImageWriter final
+	{
+	public:
+		explicit ImageWriter(uint32_t threadCount = 1, uint32_t maxQueuedFrames = 4);
+		//Writes every frame that is still queued
+		~ImageWriter();
+
+		ImageWriter(const ImageWriter&) = delete;
+		ImageWriter(ImageWriter&&) noexcept = delete;
+		ImageWriter& operator=(const ImageWriter&) = delete;
+		ImageWriter& operator=(ImageWriter&&) noexcept = delete;
+
+		//Copies the pixels of the target and returns, the format is taken from the extension of the path
+		void Submit(RenderTarget const& target, std::filesystem::path path);
+		void Submit(RenderTarget const& target, std::filesystem::path path, ImageFormat format);
+
+		//Blocks until every submitted frame is written, returns how many writes failed so far
+		uint32_t Flush();
+
+		//frame_00000.png, ... for image sequences
+		static std::filesystem::path GetSequencePath(std::filesystem::path const& directory, uint32_t frame, ImageFormat format);
+		static char const* GetExtension(ImageFormat format) noexcept;
+		//Unknown extensions are written as BMP
+		static ImageFormat GetFormat(std::filesystem::path const& path);
+
+	private:
+		struct Frame
+		{
+			std::vector<uint32_t> pixels{};
+			int width{};
+			int height{};
+			std::filesystem::path path{};
+			ImageFormat format{ ImageFormat::BMP };
+		};
+
+		uint32_t const m_MaxQueuedFrames;
+
+		std::mutex m_Mutex{};
+		//signaled when a frame is queued or the writer stops
+		std::condition_variable m_FrameQueued{};
+		//signaled when a frame is taken from the queue or written
+		std::condition_variable m_FrameDone{};
+
+		std::deque<Frame> m_Queue{};
+		//pixel buffers of written frames, reused by the next submits
+		std::vector<std::vector<uint32_t>> m_FreeBuffers{};
+		//queued or being copied by Submit, bounded by m_MaxQueuedFrames
+		uint32_t m_QueuedFrames{ 0 };
+		//also counts the frames being written
+		uint32_t m_PendingFrames{ 0 };
+		uint32_t m_FailedWrites{ 0 };
+		bool m_IsStopping{ false };
+
+		std::vector<std::thread> m_Threads{};
+
+		void Run();
+
+		static bool Write(Frame const& frame);
+		static bool WriteQOI(Frame const& frame);
+		static bool WriteRaw(Frame const& frame);
+	};
+}
@@ -1,61 +1,370 @@
 #pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <span>
+
+#include "MathHelpers.h"
+#include "Simd.h"
 #include "Vector3.h"
 #include "Vector4.h"
 
 namespace dae {
+	//Inline, products and transforms run on the SIMD backend of Simd.h one row at a time
+	//Row vectors are multiplied from the left (v * M) so a transform is a sum of scaled rows, nothing is shuffled
 	struct Matrix
 	{
 		Matrix() = default;
-		Matrix(
+		constexpr Matrix(
 			const Vector3& xAxis,
 			const Vector3& yAxis,
 			const Vector3& zAxis,
-			const Vector3& t);
+			const Vector3& t) :
+			Matrix({ xAxis, 0 }, { yAxis, 0 }, { zAxis, 0 }, { t, 1 })
+		{
+		}
 
-		Matrix(
+		constexpr Matrix(
 			const Vector4& xAxis,
 			const Vector4& yAxis,
 			const Vector4& zAxis,
-			const Vector4& t);
-
-		Matrix(const Matrix& m);
-
-		Vector3 TransformVector(const Vector3& v) const;
-		Vector3 TransformVector(float x, float y, float z) const;
-		Vector3 TransformPoint(const Vector3& p) const;
-		Vector3 TransformPoint(float x, float y, float z) const;
-
-		Vector4 TransformPoint(const Vector4& p) const;
-		Vector4 TransformPoint(float x, float y, float z, float w) const;
-
-		const Matrix& Transpose();
-		const Matrix& Inverse();
-
-		Vector3 GetAxisX() const;
-		Vector3 GetAxisY() const;
-		Vector3 GetAxisZ() const;
-		Vector3 GetTranslation() const;
-
-		static Matrix CreateTranslation(float x, float y, float z);
-		static Matrix CreateTranslation(const Vector3& t);
-		static Matrix CreateRotationX(float pitch);
-		static Matrix CreateRotationY(float yaw);
-		static Matrix CreateRotationZ(float roll);
-		static Matrix CreateRotation(float pitch, float yaw, float roll);
-		static Matrix CreateRotation(const Vector3& r);
-		static Matrix CreateScale(float sx, float sy, float sz);
-		static Matrix CreateScale(const Vector3& s);
-		static Matrix Transpose(const Matrix& m);
-		static Matrix Inverse(const Matrix& m);
-
-		static Matrix CreateLookAtLH(const Vector3& origin, const Vector3& forward, const Vector3& up);
-		static Matrix CreatePerspectiveFovLH(float fovy, float aspect, float zn, float zf);
-
-		Vector4& operator[](int index);
-		Vector4 operator[](int index) const;
-		Matrix operator*(const Matrix& m) const;
-		const Matrix& operator*=(const Matrix& m);
-		bool operator==(const Matrix& m) const;
+			const Vector4& t) :
+			data{ xAxis, yAxis, zAxis, t }
+		{
+		}
+
+		Matrix(const Matrix& m) = default;
+		Matrix& operator=(const Matrix& m) = default;
+
+		Vector3 TransformVector(const Vector3& v) const
+		{
+			return TransformVector(v.x, v.y, v.z);
+		}
+		Vector3 TransformVector(float x, float y, float z) const
+		{
+			simd::Float4 const result{ simd::MulAdd(data[2].Load(), simd::Splat(z),
+				simd::MulAdd(data[1].Load(), simd::Splat(y), simd::Mul(data[0].Load(), simd::Splat(x)))) };
+			return Vector4::FromSimd(result).GetXYZ();
+		}
+		Vector3 TransformPoint(const Vector3& p) const
+		{
+			return TransformPoint(p.x, p.y, p.z);
+		}
+		Vector3 TransformPoint(float x, float y, float z) const
+		{
+			return TransformPoint(x, y, z, 1.f).GetXYZ();
+		}
+
+		Vector4 TransformPoint(const Vector4& p) const
+		{
+			return TransformPoint(p.x, p.y, p.z, p.w);
+		}
+		Vector4 TransformPoint(float x, float y, float z, float w) const
+		{
+			return Vector4::FromSimd(Transform(simd::Splat(x), simd::Splat(y), simd::Splat(z), simd::Splat(w)));
+		}
+
+		//Batch versions of the transforms above, out holds at least as many elements as the input and may be the input itself
+		//Every element gets exactly the result of the single element call
+		void TransformPoints(std::span<const Vector3> points, std::span<Vector4> out) const
+		{
+			assert(out.size() >= points.size());
+			for (size_t i{ 0 }; i < points.size(); ++i)
+				out[i].Store(Transform(simd::Splat(points[i].x), simd::Splat(points[i].y), simd::Splat(points[i].z), simd::Splat(1.f)));
+		}
+		void TransformPoints(std::span<const Vector4> points, std::span<Vector4> out) const
+		{
+			assert(out.size() >= points.size());
+			for (size_t i{ 0 }; i < points.size(); ++i)
+				out[i].Store(Transform(points[i].Load()));
+		}
+		void TransformPoints(std::span<const Vector3> points, std::span<Vector3> out) const
+		{
+			assert(out.size() >= points.size());
+			for (size_t i{ 0 }; i < points.size(); ++i)
+				out[i] = TransformPoint(points[i]);
+		}
+		void TransformVectors(std::span<const Vector3> vectors, std::span<Vector3> out) const
+		{
+			assert(out.size() >= vectors.size());
+			for (size_t i{ 0 }; i < vectors.size(); ++i)
+				out[i] = TransformVector(vectors[i]);
+		}
+
+		//Structure of arrays, four points per step with one matrix element per register
+		//Points before the first 16 byte aligned output and the last count % 4 points are transformed one at a time
+		void TransformPoints(std::span<const float> x, std::span<const float> y, std::span<const float> z,
+			std::span<float> outX, std::span<float> outY, std::span<float> outZ, std::span<float> outW) const
+		{
+			size_t const count{ x.size() };
+			assert(y.size() == count && z.size() == count);
+			assert(outX.size() >= count && outY.size() >= count && outZ.size() >= count && outW.size() >= count);
+
+			auto const transformOne{ [&](size_t i)
+			{
+				Vector4 const p{ TransformPoint(x[i], y[i], z[i], 1.f) };
+				outX[i] = p.x;
+				outY[i] = p.y;
+				outZ[i] = p.z;
+				outW[i] = p.w;
+			} };
+
+			size_t i{ GetAlignedStart(outX.data(), count) };
+			for (size_t head{ 0 }; head < i; ++head)
+				transformOne(head);
+
+			Columns const columns{ GetColumns() };
+			for (; i + 4 <= count; i += 4)
+			{
+				simd::Float4 const px{ simd::Load(&x[i]) };
+				simd::Float4 const py{ simd::Load(&y[i]) };
+				simd::Float4 const pz{ simd::Load(&z[i]) };
+				//the translation is added as is, the single point version multiplies it by w = 1 which changes nothing
+				simd::Store(&outX[i], simd::Add(columns.Dot3(0, px, py, pz), columns.m[3][0]));
+				simd::Store(&outY[i], simd::Add(columns.Dot3(1, px, py, pz), columns.m[3][1]));
+				simd::Store(&outZ[i], simd::Add(columns.Dot3(2, px, py, pz), columns.m[3][2]));
+				simd::Store(&outW[i], simd::Add(columns.Dot3(3, px, py, pz), columns.m[3][3]));
+			}
+
+			for (; i < count; ++i)
+				transformOne(i);
+		}
+		void TransformVectors(std::span<const float> x, std::span<const float> y, std::span<const float> z,
+			std::span<float> outX, std::span<float> outY, std::span<float> outZ) const
+		{
+			size_t const count{ x.size() };
+			assert(y.size() == count && z.size() == count);
+			assert(outX.size() >= count && outY.size() >= count && outZ.size() >= count);
+
+			auto const transformOne{ [&](size_t i)
+			{
+				Vector3 const v{ TransformVector(x[i], y[i], z[i]) };
+				outX[i] = v.x;
+				outY[i] = v.y;
+				outZ[i] = v.z;
+			} };
+
+			size_t i{ GetAlignedStart(outX.data(), count) };
+			for (size_t head{ 0 }; head < i; ++head)
+				transformOne(head);
+
+			Columns const columns{ GetColumns() };
+			for (; i + 4 <= count; i += 4)
+			{
+				simd::Float4 const vx{ simd::Load(&x[i]) };
+				simd::Float4 const vy{ simd::Load(&y[i]) };
+				simd::Float4 const vz{ simd::Load(&z[i]) };
+				simd::Store(&outX[i], columns.Dot3(0, vx, vy, vz));
+				simd::Store(&outY[i], columns.Dot3(1, vx, vy, vz));
+				simd::Store(&outZ[i], columns.Dot3(2, vx, vy, vz));
+			}
+
+			for (; i < count; ++i)
+				transformOne(i);
+		}
+
+		const Matrix& Transpose()
+		{
+			simd::Float4 r0{ data[0].Load() };
+			simd::Float4 r1{ data[1].Load() };
+			simd::Float4 r2{ data[2].Load() };
+			simd::Float4 r3{ data[3].Load() };
+			simd::Transpose(r0, r1, r2, r3);
+
+			Store(r0, r1, r2, r3);
+			return *this;
+		}
+		const Matrix& Inverse()
+		{
+			//Optimized Inverse as explained in FGED1 - used widely in other libraries too.
+			//a, b, c and d are the rows, only their xyz take part in the cross and dot products
+			simd::Float4 const a{ data[0].Load() };
+			simd::Float4 const b{ data[1].Load() };
+			simd::Float4 const c{ data[2].Load() };
+			simd::Float4 const d{ data[3].Load() };
+
+			const float x = data[0][3];
+			const float y = data[1][3];
+			const float z = data[2][3];
+			const float w = data[3][3];
+
+			simd::Float4 s{ simd::Cross3(a, b) };
+			simd::Float4 t{ simd::Cross3(c, d) };
+			simd::Float4 u{ simd::Sub(simd::Mul(a, simd::Splat(y)), simd::Mul(b, simd::Splat(x))) };
+			simd::Float4 v{ simd::Sub(simd::Mul(c, simd::Splat(w)), simd::Mul(d, simd::Splat(z))) };
+
+			float det = simd::Dot3(s, v) + simd::Dot3(t, u);
+			assert((!AreEqual(det, 0.f)) && "ERROR: determinant is 0, there is no INVERSE!");
+			simd::Float4 const invDet{ simd::Splat(1.f / det) };
+
+			s = simd::Mul(s, invDet); t = simd::Mul(t, invDet); u = simd::Mul(u, invDet); v = simd::Mul(v, invDet);
+
+			//the columns of the inverse, r3 is 0 for affine matrices
+			simd::Float4 r0{ simd::Add(simd::Cross3(b, v), simd::Mul(t, simd::Splat(y))) };
+			simd::Float4 r1{ simd::Sub(simd::Cross3(v, a), simd::Mul(t, simd::Splat(x))) };
+			simd::Float4 r2{ simd::Add(simd::Cross3(d, u), simd::Mul(s, simd::Splat(w))) };
+			simd::Float4 r3{ simd::Sub(simd::Cross3(u, c), simd::Mul(s, simd::Splat(z))) };
+			simd::Transpose(r0, r1, r2, r3);
+
+			Store(r0, r1, r2, simd::Set(-simd::Dot3(b, t), simd::Dot3(a, t), -simd::Dot3(d, s), simd::Dot3(c, s)));
+			return *this;
+		}
+
+		Vector3 GetAxisX() const
+		{
+			return data[0];
+		}
+		Vector3 GetAxisY() const
+		{
+			return data[1];
+		}
+		Vector3 GetAxisZ() const
+		{
+			return data[2];
+		}
+		Vector3 GetTranslation() const
+		{
+			return data[3];
+		}
+
+		static Matrix CreateTranslation(float x, float y, float z)
+		{
+			return CreateTranslation({ x, y, z });
+		}
+		static Matrix CreateTranslation(const Vector3& t)
+		{
+			return { Vector3::UnitX, Vector3::UnitY, Vector3::UnitZ, t };
+		}
+		static Matrix CreateRotationX(float pitch)
+		{
+			return {
+				{1, 0, 0, 0},
+				{0, std::cos(pitch), -std::sin(pitch), 0},
+				{0, std::sin(pitch), std::cos(pitch), 0},
+				{0, 0, 0, 1}
+			};
+		}
+		static Matrix CreateRotationY(float yaw)
+		{
+			return {
+				{std::cos(yaw), 0, -std::sin(yaw), 0},
+				{0, 1, 0, 0},
+				{std::sin(yaw), 0, std::cos(yaw), 0},
+				{0, 0, 0, 1}
+			};
+		}
+		static Matrix CreateRotationZ(float roll)
+		{
+			return {
+				{std::cos(roll), std::sin(roll), 0, 0},
+				{-std::sin(roll), std::cos(roll), 0, 0},
+				{0, 0, 1, 0},
+				{0, 0, 0, 1}
+			};
+		}
+		static Matrix CreateRotation(float pitch, float yaw, float roll)
+		{
+			return CreateRotation({ pitch, yaw, roll });
+		}
+		static Matrix CreateRotation(const Vector3& r)
+		{
+			return CreateRotationX(r[0]) * CreateRotationY(r[1]) * CreateRotationZ(r[2]);
+		}
+		static Matrix CreateScale(float sx, float sy, float sz)
+		{
+			return { {sx, 0, 0}, {0, sy, 0}, {0, 0, sz}, Vector3::Zero };
+		}
+		static Matrix CreateScale(const Vector3& s)
+		{
+			return CreateScale(s[0], s[1], s[2]);
+		}
+		static Matrix Transpose(const Matrix& m)
+		{
+			Matrix out{ m };
+			out.Transpose();
+
+			return out;
+		}
+		static Matrix Inverse(const Matrix& m)
+		{
+			Matrix out{ m };
+			out.Inverse();
+
+			return out;
+		}
+
+		//View matrix of a camera at origin looking along forward, the inverse of its { right, up, forward, origin } matrix
+		static Matrix CreateLookAtLH(const Vector3& origin, const Vector3& forward, const Vector3& up)
+		{
+			Vector3 const zAxis{ forward.Normalized() };
+			Vector3 const xAxis{ Vector3::Cross(up, zAxis).Normalized() };
+			Vector3 const yAxis{ Vector3::Cross(zAxis, xAxis) };
+
+			return {
+				{ xAxis.x, yAxis.x, zAxis.x, 0.f },
+				{ xAxis.y, yAxis.y, zAxis.y, 0.f },
+				{ xAxis.z, yAxis.z, zAxis.z, 0.f },
+				{ -Vector3::Dot(xAxis, origin), -Vector3::Dot(yAxis, origin), -Vector3::Dot(zAxis, origin), 1.f }
+			};
+		}
+		static Matrix CreatePerspectiveFovLH(float fov, float aspect, float zn, float zf)
+		{
+			return{
+				{ 1.f / (aspect * fov), 0.f, 0.f, 0.f },
+				{ 0.f, 1.f / fov, 0.f, 0.f },
+				{ 0.f, 0.f, zf / (zf - zn), 1.f},
+				{ 0.f, 0.f, -(zf * zn) / (zf - zn), 0.f }
+			};
+		}
+		//Maps the near plane to 1 and the far plane to 0
+		static Matrix CreatePerspectiveFovLHReversedZ(float fov, float aspect, float zn, float zf)
+		{
+			//1 - z of CreatePerspectiveFovLH, folded into the matrix
+			return{
+				{ 1.f / (aspect * fov), 0.f, 0.f, 0.f },
+				{ 0.f, 1.f / fov, 0.f, 0.f },
+				{ 0.f, 0.f, zn / (zn - zf), 1.f},
+				{ 0.f, 0.f, (zf * zn) / (zf - zn), 0.f }
+			};
+		}
+
+#pragma region Operator Overloads
+		Vector4& operator[](int index)
+		{
+			assert(index <= 3 && index >= 0);
+			return data[index];
+		}
+		Vector4 operator[](int index) const
+		{
+			assert(index <= 3 && index >= 0);
+			return data[index];
+		}
+		//Row r of the product is row r of this matrix transforming m
+		Matrix operator*(const Matrix& m) const
+		{
+			Matrix result{ *this };
+			result *= m;
+			return result;
+		}
+		const Matrix& operator*=(const Matrix& m)
+		{
+			simd::Float4 const r0{ m.Transform(data[0].Load()) };
+			simd::Float4 const r1{ m.Transform(data[1].Load()) };
+			simd::Float4 const r2{ m.Transform(data[2].Load()) };
+			simd::Float4 const r3{ m.Transform(data[3].Load()) };
+
+			Store(r0, r1, r2, r3);
+			return *this;
+		}
+		bool operator==(const Matrix& m) const
+		{
+			return data[0] == m.data[0]
+				&& data[1] == m.data[1]
+				&& data[2] == m.data[2]
+				&& data[3] == m.data[3];
+		}
+#pragma endregion
 
 	private:
 
@@ -72,5 +381,56 @@ namespace dae {
 		// v1x v1y v1z v1w
 		// v2x v2y v2z v2w
 		// v3x v3y v3z v3w
+
+		//x * row 0 + y * row 1 + z * row 2 + w * row 3, summed in the order of the scalar dot products
+		simd::Float4 Transform(simd::Float4 x, simd::Float4 y, simd::Float4 z, simd::Float4 w) const noexcept
+		{
+			simd::Float4 result{ simd::Mul(data[0].Load(), x) };
+			result = simd::MulAdd(data[1].Load(), y, result);
+			result = simd::MulAdd(data[2].Load(), z, result);
+			return simd::MulAdd(data[3].Load(), w, result);
+		}
+		simd::Float4 Transform(simd::Float4 v) const noexcept
+		{
+			return Transform(simd::Shuffle<0, 0, 0, 0>(v), simd::Shuffle<1, 1, 1, 1>(v), simd::Shuffle<2, 2, 2, 2>(v), simd::Shuffle<3, 3, 3, 3>(v));
+		}
+
+		//Every element in its own register, m[row][column], for transforming four points of a structure of arrays at once
+		struct Columns
+		{
+			simd::Float4 m[4][4];
+
+			//x * m[0][c] + y * m[1][c] + z * m[2][c], four points at once
+			simd::Float4 Dot3(int c, simd::Float4 x, simd::Float4 y, simd::Float4 z) const noexcept
+			{
+				return simd::MulAdd(z, m[2][c], simd::MulAdd(y, m[1][c], simd::Mul(x, m[0][c])));
+			}
+		};
+		Columns GetColumns() const noexcept
+		{
+			Columns columns;
+			for (int r{ 0 }; r < 4; ++r)
+			{
+				for (int c{ 0 }; c < 4; ++c)
+					columns.m[r][c] = simd::Splat(data[r][c]);
+			}
+			return columns;
+		}
+
+		//Elements before the first one whose output is 16 byte aligned, the wide loop starts there so its stores never split a cache line
+		//when every stream is allocated alike, which is the usual case, all of them are aligned from there on
+		static size_t GetAlignedStart(float const* pOut, size_t count) noexcept
+		{
+			size_t const misalignment{ (reinterpret_cast<uintptr_t>(pOut) / sizeof(float)) % 4 };
+			return std::min(misalignment ? 4 - misalignment : 0, count);
+		}
+
+		void Store(simd::Float4 r0, simd::Float4 r1, simd::Float4 r2, simd::Float4 r3) noexcept
+		{
+			data[0].Store(r0);
+			data[1].Store(r1);
+			data[2].Store(r2);
+			data[3].Store(r3);
+		}
 	};
-}
\ No newline at end of file
+}
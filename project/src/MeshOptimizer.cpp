@@ -0,0 +1,809 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+#include <unordered_map>
+
+#include "DataTypes.h"
+
+namespace dae
+{
+	namespace MeshOptimizer
+	{
+		namespace
+		{
+			//Favours meshlets with narrow normal cones over meshlets with few vertices
+			constexpr float MeshletConeWeight{ 2.f };
+			//A meshlet with at least this many triangles is finished when a triangle deviates more than acos(MeshletMinConeCos) from its cone axis
+			constexpr uint32_t MeshletMinConeTriangles{ 16 };
+			constexpr float MeshletMinConeCos{ .5f };
+
+			//Vertex -> triangles, flattened
+			struct TriangleAdjacency
+			{
+				std::vector<uint32_t> counts{};
+				std::vector<uint32_t> offsets{};
+				std::vector<uint32_t> triangles{};
+			};
+
+			TriangleAdjacency BuildTriangleAdjacency(std::vector<uint32_t> const& indices, size_t vertexCount)
+			{
+				TriangleAdjacency adjacency{};
+				adjacency.counts.assign(vertexCount, 0);
+				for (uint32_t const index : indices)
+					++adjacency.counts[index];
+
+				adjacency.offsets.assign(vertexCount + 1, 0);
+				for (size_t v{ 0 }; v < vertexCount; ++v)
+					adjacency.offsets[v + 1] = adjacency.offsets[v] + adjacency.counts[v];
+
+				adjacency.triangles.resize(indices.size());
+				std::vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+				for (size_t i{ 0 }; i < indices.size(); ++i)
+					adjacency.triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+				return adjacency;
+			}
+
+			void CalculateMeshletBounds(MeshData const& mesh, std::vector<uint32_t> const& indices, Meshlet& meshlet)
+			{
+				//Bounding sphere around the center of the meshlet's AABB
+				AABB box{};
+				for (uint32_t i{ 0 }; i < meshlet.vertexCount; ++i)
+					box.Grow(mesh.vertices[mesh.meshletVertices[meshlet.vertexOffset + i]].position);
+
+				meshlet.bounds.center = (box.min + box.max) * .5f;
+				meshlet.bounds.radius = 0.f;
+				for (uint32_t i{ 0 }; i < meshlet.vertexCount; ++i)
+				{
+					Vector3 const& p{ mesh.vertices[mesh.meshletVertices[meshlet.vertexOffset + i]].position };
+					meshlet.bounds.radius = std::max(meshlet.bounds.radius, (p - meshlet.bounds.center).Magnitude());
+				}
+
+				//Normal cone - uses the geometric normal in index order, as that's what decides which side the rasterizer draws
+				std::vector<Vector3> normals{};
+				normals.reserve(meshlet.triangleCount);
+
+				Vector3 axis{};
+				for (uint32_t t{ 0 }; t < meshlet.triangleCount; ++t)
+				{
+					uint32_t const first{ meshlet.indexOffset + t * 3 };
+					Vector3 const& p0{ mesh.vertices[indices[first]].position };
+					Vector3 const& p1{ mesh.vertices[indices[first + 1]].position };
+					Vector3 const& p2{ mesh.vertices[indices[first + 2]].position };
+
+					Vector3 const normal{ Vector3::Cross(p1 - p0, p2 - p0) };
+					float const length{ normal.Magnitude() };
+					if (length <= FLT_EPSILON)
+						continue;
+
+					normals.emplace_back(normal / length);
+					axis += normals.back();
+				}
+
+				meshlet.coneAxis = Vector3::Zero;
+				meshlet.coneCutoff = 1.f;
+
+				float const axisLength{ axis.Magnitude() };
+				if (normals.empty() || axisLength <= FLT_EPSILON)
+					return;
+
+				axis /= axisLength;
+
+				float minCos{ 1.f };
+				for (auto const& n : normals)
+					minCos = std::min(minCos, Vector3::Dot(n, axis));
+
+				//spread >= 90 degrees, there is always a front facing triangle
+				if (minCos <= 0.f)
+					return;
+
+				meshlet.coneAxis = axis;
+				meshlet.coneCutoff = sqrtf(1.f - Square(minCos));
+			}
+		}
+
+		namespace Forsyth
+		{
+			//Tuning values from the original paper
+			constexpr float CacheDecayPower{ 1.5f };
+			constexpr float LastTriScore{ .75f };
+			constexpr float ValenceBoostScale{ 2.f };
+			constexpr float ValenceBoostPower{ .5f };
+			constexpr uint32_t MaxValence{ 64 };
+
+			struct ScoreTable final
+			{
+				float cache[VertexCacheSize]{};
+				float valence[MaxValence + 1]{};
+
+				ScoreTable()
+				{
+					for (uint32_t i{ 0 }; i < VertexCacheSize; ++i)
+					{
+						//the vertices of the last triangle get a fixed score, so their order doesn't matter
+						if (i < 3)
+						{
+							cache[i] = LastTriScore;
+							continue;
+						}
+
+						float const scaler{ 1.f / (VertexCacheSize - 3) };
+						cache[i] = powf(1.f - (i - 3) * scaler, CacheDecayPower);
+					}
+
+					//boost vertices with few triangles left, so lone triangles aren't left behind
+					valence[0] = 0.f;
+					for (uint32_t i{ 1 }; i <= MaxValence; ++i)
+						valence[i] = ValenceBoostScale * powf(static_cast<float>(i), -ValenceBoostPower);
+				}
+
+				float VertexScore(int cachePosition, uint32_t remainingValence) const
+				{
+					if (remainingValence == 0)
+						return -1.f;
+
+					float score{ valence[std::min(remainingValence, MaxValence)] };
+					if (cachePosition >= 0)
+						score += cache[cachePosition];
+
+					return score;
+				}
+			};
+		}
+
+		namespace QEM
+		{
+			//Border edges get a plane perpendicular to the face, weighted higher so the silhouette of open meshes is kept
+			constexpr double BorderWeight{ 10.0 };
+			//Collapses in one pass may cost up to this much more than the collapse that would reach the target
+			constexpr float PassErrorScale{ 1.5f };
+
+			//Symmetric 4x4 plane quadric (Garland & Heckbert), area weighted
+			struct Quadric final
+			{
+				double a2{}, ab{}, ac{}, ad{};
+				double b2{}, bc{}, bd{};
+				double c2{}, cd{};
+				double d2{};
+				double weight{};
+
+				void AddPlane(Vector3 const& n, float d, double w) noexcept
+				{
+					a2 += w * n.x * n.x; ab += w * n.x * n.y; ac += w * n.x * n.z; ad += w * n.x * d;
+					b2 += w * n.y * n.y; bc += w * n.y * n.z; bd += w * n.y * d;
+					c2 += w * n.z * n.z; cd += w * n.z * d;
+					d2 += w * d * d;
+					weight += w;
+				}
+
+				Quadric& operator+=(Quadric const& q) noexcept
+				{
+					a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+					b2 += q.b2; bc += q.bc; bd += q.bd;
+					c2 += q.c2; cd += q.cd;
+					d2 += q.d2;
+					weight += q.weight;
+					return *this;
+				}
+
+				//Weighted squared distance of p to all planes
+				double Evaluate(Vector3 const& p) const noexcept
+				{
+					double const x{ p.x }, y{ p.y }, z{ p.z };
+					double const error{ a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+						+ b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+						+ c2 * z * z + 2.0 * cd * z
+						+ d2 };
+					return std::max(error, 0.0);
+				}
+			};
+
+			//Collapsing from into to, error is a distance in object space
+			struct Collapse final
+			{
+				uint32_t from{};
+				uint32_t to{};
+				float error{};
+			};
+
+			uint64_t EdgeKey(uint32_t a, uint32_t b) noexcept
+			{
+				return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+			}
+
+			//Vertices that only differ in their attributes (uv/normal seams) share a position id
+			uint32_t BuildPositionIds(std::vector<Vertex> const& vertices, std::vector<uint32_t>& positionIds, std::vector<Vector3>& positions)
+			{
+				auto const isLess{ [&](uint32_t a, uint32_t b)
+				{
+					Vector3 const& pa{ vertices[a].position };
+					Vector3 const& pb{ vertices[b].position };
+					return std::tie(pa.x, pa.y, pa.z) < std::tie(pb.x, pb.y, pb.z);
+				} };
+
+				std::vector<uint32_t> order(vertices.size());
+				std::iota(order.begin(), order.end(), 0);
+				std::sort(order.begin(), order.end(), isLess);
+
+				positionIds.resize(vertices.size());
+				positions.clear();
+				for (size_t i{ 0 }; i < order.size(); ++i)
+				{
+					if (i == 0 || isLess(order[i - 1], order[i]))
+						positions.emplace_back(vertices[order[i]].position);
+					positionIds[order[i]] = static_cast<uint32_t>(positions.size() - 1);
+				}
+
+				return static_cast<uint32_t>(positions.size());
+			}
+		}
+
+		float CalculateACMR(std::vector<uint32_t> const& indices, size_t vertexCount, uint32_t cacheSize)
+		{
+			if (indices.size() < 3)
+				return 0.f;
+
+			//FIFO cache, a vertex is in the cache when it was added less than cacheSize misses ago
+			std::vector<uint32_t> timestamps(vertexCount, 0);
+			uint32_t misses{ 0 };
+			for (uint32_t const index : indices)
+			{
+				if (timestamps[index] == 0 || misses + 1 - timestamps[index] > cacheSize)
+				{
+					++misses;
+					timestamps[index] = misses;
+				}
+			}
+
+			return static_cast<float>(misses) / (indices.size() / 3);
+		}
+
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+		{
+			size_t const triangleCount{ indices.size() / 3 };
+			if (triangleCount == 0)
+				return;
+
+			static Forsyth::ScoreTable const scoreTable{};
+
+			//Valence (count) is the amount of triangles left, emitted triangles are swapped out of the adjacency
+			TriangleAdjacency adjacencyData{ BuildTriangleAdjacency(indices, vertexCount) };
+			std::vector<uint32_t>& valence{ adjacencyData.counts };
+			std::vector<uint32_t> const& adjacencyOffset{ adjacencyData.offsets };
+			std::vector<uint32_t>& adjacency{ adjacencyData.triangles };
+
+			std::vector<float> vertexScore(vertexCount);
+			for (size_t v{ 0 }; v < vertexCount; ++v)
+				vertexScore[v] = scoreTable.VertexScore(-1, valence[v]);
+
+			std::vector<float> triangleScore(triangleCount);
+			for (size_t t{ 0 }; t < triangleCount; ++t)
+				triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+			std::vector<bool> isEmitted(triangleCount, false);
+			std::vector<uint32_t> result{};
+			result.reserve(indices.size());
+
+			//3 extra slots hold the vertices pushed out by the newest triangle
+			std::vector<uint32_t> cache{};
+			cache.reserve(VertexCacheSize + 3);
+			std::vector<uint32_t> nextCache{};
+			nextCache.reserve(VertexCacheSize + 3);
+
+			size_t scanCursor{ 0 };
+			size_t bestTriangle{ 0 };
+			while (true)
+			{
+				isEmitted[bestTriangle] = true;
+				uint32_t const* pTriangle{ &indices[bestTriangle * 3] };
+				result.insert(result.end(), pTriangle, pTriangle + 3);
+
+				//The new triangle's vertices move to the front, the others shift back
+				nextCache.assign(pTriangle, pTriangle + 3);
+				for (uint32_t const v : cache)
+				{
+					if (v != pTriangle[0] && v != pTriangle[1] && v != pTriangle[2])
+						nextCache.emplace_back(v);
+				}
+				std::swap(cache, nextCache);
+
+				for (uint32_t i{ 0 }; i < 3; ++i)
+				{
+					uint32_t const v{ pTriangle[i] };
+					--valence[v];
+
+					//remove the emitted triangle from the vertex' adjacency so only live triangles are scored
+					uint32_t* pBegin{ &adjacency[adjacencyOffset[v]] };
+					uint32_t* pEnd{ pBegin + valence[v] + 1 };
+					*std::find(pBegin, pEnd, static_cast<uint32_t>(bestTriangle)) = *(pEnd - 1);
+				}
+
+				//Update scores of everything in (or just evicted from) the cache
+				for (size_t i{ 0 }; i < cache.size(); ++i)
+				{
+					uint32_t const v{ cache[i] };
+					int const position{ i < VertexCacheSize ? static_cast<int>(i) : -1 };
+
+					float const newScore{ scoreTable.VertexScore(position, valence[v]) };
+					float const delta{ newScore - vertexScore[v] };
+					vertexScore[v] = newScore;
+
+					for (uint32_t a{ adjacencyOffset[v] }; a < adjacencyOffset[v] + valence[v]; ++a)
+						triangleScore[adjacency[a]] += delta;
+				}
+
+				if (cache.size() > VertexCacheSize)
+					cache.resize(VertexCacheSize);
+
+				//Best next triangle is one that uses a cached vertex
+				float bestScore{ -1.f };
+				for (uint32_t const v : cache)
+				{
+					for (uint32_t a{ adjacencyOffset[v] }; a < adjacencyOffset[v] + valence[v]; ++a)
+					{
+						uint32_t const t{ adjacency[a] };
+						if (triangleScore[t] > bestScore)
+						{
+							bestScore = triangleScore[t];
+							bestTriangle = t;
+						}
+					}
+				}
+
+				if (result.size() == indices.size())
+					break;
+
+				//Nothing adjacent to the cache left, continue with the next unemitted triangle
+				if (bestScore < 0.f)
+				{
+					while (isEmitted[scanCursor])
+						++scanCursor;
+					bestTriangle = scanCursor;
+				}
+			}
+
+			indices = std::move(result);
+		}
+
+		void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+		{
+			constexpr uint32_t unassigned{ UINT32_MAX };
+			std::vector<uint32_t> remap(vertices.size(), unassigned);
+
+			std::vector<Vertex> result{};
+			result.reserve(vertices.size());
+
+			for (uint32_t& index : indices)
+			{
+				if (remap[index] == unassigned)
+				{
+					remap[index] = static_cast<uint32_t>(result.size());
+					result.emplace_back(vertices[index]);
+				}
+				index = remap[index];
+			}
+
+			vertices = std::move(result);
+		}
+
+		void BuildMeshlets(MeshData& mesh, uint32_t maxVertices, uint32_t maxTriangles)
+		{
+			mesh.meshlets.clear();
+			mesh.meshletVertices.clear();
+
+			if (mesh.primitiveTopology != PrimitiveTopology::TriangleList || mesh.indices.empty())
+				return;
+
+			size_t const triangleCount{ mesh.indices.size() / 3 };
+			TriangleAdjacency const adjacency{ BuildTriangleAdjacency(mesh.indices, mesh.vertices.size()) };
+
+			std::vector<Vector3> triangleNormals(triangleCount);
+			for (size_t t{ 0 }; t < triangleCount; ++t)
+			{
+				Vector3 const& p0{ mesh.vertices[mesh.indices[t * 3]].position };
+				Vector3 const& p1{ mesh.vertices[mesh.indices[t * 3 + 1]].position };
+				Vector3 const& p2{ mesh.vertices[mesh.indices[t * 3 + 2]].position };
+
+				Vector3 const normal{ Vector3::Cross(p1 - p0, p2 - p0) };
+				float const length{ normal.Magnitude() };
+				triangleNormals[t] = length > FLT_EPSILON ? normal / length : Vector3::Zero;
+			}
+
+			//remembers in which meshlet a vertex was last added, avoids a lookup through the meshlet's vertices
+			constexpr uint32_t invalidMeshlet{ UINT32_MAX };
+			std::vector<uint32_t> vertexMeshlet(mesh.vertices.size(), invalidMeshlet);
+			std::vector<bool> isEmitted(triangleCount, false);
+
+			//triangles are written in meshlet order so every meshlet is a contiguous index range
+			std::vector<uint32_t> indices{};
+			indices.reserve(mesh.indices.size());
+
+			Meshlet current{};
+			Vector3 coneSum{};
+
+			auto const countNewVertices{ [&](size_t t)
+			{
+				uint32_t const currentIdx{ static_cast<uint32_t>(mesh.meshlets.size()) };
+				uint32_t newVertices{ 0 };
+				for (uint32_t v{ 0 }; v < 3; ++v)
+				{
+					if (vertexMeshlet[mesh.indices[t * 3 + v]] != currentIdx)
+						++newVertices;
+				}
+				return newVertices;
+			} };
+
+			auto const finishMeshlet{ [&]()
+			{
+				if (current.triangleCount == 0)
+					return;
+
+				CalculateMeshletBounds(mesh, indices, current);
+				mesh.meshlets.emplace_back(current);
+
+				current = {};
+				current.vertexOffset = static_cast<uint32_t>(mesh.meshletVertices.size());
+				current.indexOffset = static_cast<uint32_t>(indices.size());
+				coneSum = Vector3::Zero;
+			} };
+
+			auto const emitTriangle{ [&](size_t t)
+			{
+				uint32_t const currentIdx{ static_cast<uint32_t>(mesh.meshlets.size()) };
+				for (uint32_t v{ 0 }; v < 3; ++v)
+				{
+					uint32_t const index{ mesh.indices[t * 3 + v] };
+					indices.emplace_back(index);
+
+					if (vertexMeshlet[index] == currentIdx)
+						continue;
+
+					vertexMeshlet[index] = currentIdx;
+					mesh.meshletVertices.emplace_back(index);
+					++current.vertexCount;
+				}
+
+				++current.triangleCount;
+				coneSum += triangleNormals[t];
+				isEmitted[t] = true;
+			} };
+
+			size_t scanCursor{ 0 };
+			for (size_t emitted{ 0 }; emitted < triangleCount; ++emitted)
+			{
+				//Grow the meshlet with the neighbouring triangle that adds the fewest vertices and widens the normal cone the least
+				Vector3 const coneAxis{ coneSum.SqrMagnitude() > FLT_EPSILON ? coneSum.Normalized() : Vector3::Zero };
+
+				size_t bestTriangle{ triangleCount };
+				float bestScore{ FLT_MAX };
+				for (uint32_t i{ current.vertexOffset }; i < current.vertexOffset + current.vertexCount; ++i)
+				{
+					uint32_t const v{ mesh.meshletVertices[i] };
+					for (uint32_t a{ adjacency.offsets[v] }; a < adjacency.offsets[v + 1]; ++a)
+					{
+						uint32_t const t{ adjacency.triangles[a] };
+						if (isEmitted[t])
+							continue;
+
+						uint32_t const newVertices{ countNewVertices(t) };
+						if (current.vertexCount + newVertices > maxVertices)
+							continue;
+
+						float const score{ newVertices + MeshletConeWeight * (1.f - Vector3::Dot(triangleNormals[t], coneAxis)) };
+						if (score < bestScore)
+						{
+							bestScore = score;
+							bestTriangle = t;
+						}
+					}
+				}
+
+				//Not connected to anything that fits, continue in index order (spatially coherent after OptimizeVertexCache)
+				if (bestTriangle == triangleCount)
+				{
+					while (isEmitted[scanCursor])
+						++scanCursor;
+					bestTriangle = scanCursor;
+				}
+
+				//Start a new meshlet rather than letting the normal cone grow too wide to ever be culled
+				bool const isConeTooWide{ current.triangleCount >= MeshletMinConeTriangles && Vector3::Dot(triangleNormals[bestTriangle], coneAxis) < MeshletMinConeCos };
+				if (isConeTooWide || current.vertexCount + countNewVertices(bestTriangle) > maxVertices || current.triangleCount + 1 > maxTriangles)
+					finishMeshlet();
+
+				emitTriangle(bestTriangle);
+			}
+
+			finishMeshlet();
+			mesh.indices = std::move(indices);
+		}
+
+		std::vector<uint32_t> Simplify(std::vector<Vertex> const& vertices, std::vector<uint32_t> const& indices, size_t targetIndexCount, float targetError, float* pResultError)
+		{
+			std::vector<uint32_t> result{ indices };
+			float resultError{ 0.f };
+
+			std::vector<uint32_t> positionIds{};
+			std::vector<Vector3> positions{};
+			uint32_t const positionCount{ QEM::BuildPositionIds(vertices, positionIds, positions) };
+
+			//Position -> vertices, flattened
+			std::vector<uint32_t> positionVertexOffsets(positionCount + 1, 0);
+			for (uint32_t const p : positionIds)
+				++positionVertexOffsets[p + 1];
+			for (uint32_t p{ 0 }; p < positionCount; ++p)
+				positionVertexOffsets[p + 1] += positionVertexOffsets[p];
+
+			std::vector<uint32_t> positionVertices(vertices.size());
+			{
+				std::vector<uint32_t> fill(positionVertexOffsets.begin(), positionVertexOffsets.end() - 1);
+				for (uint32_t v{ 0 }; v < vertices.size(); ++v)
+					positionVertices[fill[positionIds[v]]++] = v;
+			}
+
+			//Quadrics of the planes of all triangles around a position, plus constraint planes along borders
+			std::vector<QEM::Quadric> quadrics(positionCount);
+			std::unordered_map<uint64_t, uint32_t> edgeUseCount{};
+			edgeUseCount.reserve(indices.size());
+			for (size_t t{ 0 }; t < indices.size() / 3; ++t)
+			{
+				uint32_t const p[3]{ positionIds[indices[t * 3]], positionIds[indices[t * 3 + 1]], positionIds[indices[t * 3 + 2]] };
+				if (p[0] == p[1] || p[1] == p[2] || p[2] == p[0])
+					continue;
+
+				for (uint32_t k{ 0 }; k < 3; ++k)
+					++edgeUseCount[QEM::EdgeKey(p[k], p[(k + 1) % 3])];
+			}
+
+			for (size_t t{ 0 }; t < indices.size() / 3; ++t)
+			{
+				uint32_t const p[3]{ positionIds[indices[t * 3]], positionIds[indices[t * 3 + 1]], positionIds[indices[t * 3 + 2]] };
+				if (p[0] == p[1] || p[1] == p[2] || p[2] == p[0])
+					continue;
+
+				Vector3 normal{ Vector3::Cross(positions[p[1]] - positions[p[0]], positions[p[2]] - positions[p[0]]) };
+				float const length{ normal.Magnitude() };
+				if (length <= FLT_EPSILON)
+					continue;
+
+				normal /= length;
+				for (uint32_t k{ 0 }; k < 3; ++k)
+					quadrics[p[k]].AddPlane(normal, -Vector3::Dot(normal, positions[p[0]]), length * .5f);
+
+				for (uint32_t k{ 0 }; k < 3; ++k)
+				{
+					uint32_t const a{ p[k] };
+					uint32_t const b{ p[(k + 1) % 3] };
+					if (edgeUseCount[QEM::EdgeKey(a, b)] != 1)
+						continue;
+
+					Vector3 const edge{ positions[b] - positions[a] };
+					Vector3 const borderNormal{ Vector3::Cross(edge, normal).Normalized() };
+					double const weight{ edge.SqrMagnitude() * QEM::BorderWeight };
+					float const distance{ -Vector3::Dot(borderNormal, positions[a]) };
+					quadrics[a].AddPlane(borderNormal, distance, weight);
+					quadrics[b].AddPlane(borderNormal, distance, weight);
+				}
+			}
+
+			auto const collapseError{ [&](uint32_t from, uint32_t to)
+			{
+				QEM::Quadric q{ quadrics[from] };
+				q += quadrics[to];
+				return q.weight > 0.0 ? static_cast<float>(sqrt(q.Evaluate(positions[to]) / q.weight)) : 0.f;
+			} };
+
+			constexpr uint32_t unassigned{ UINT32_MAX };
+			std::vector<uint32_t> positionIndices{};
+			std::vector<uint64_t> edges{};
+			std::vector<QEM::Collapse> collapses{};
+			std::vector<uint32_t> positionRemap(positionCount);
+			std::vector<uint32_t> vertexRemap(vertices.size());
+			std::vector<bool> isTouched(positionCount);
+
+			//Every pass collapses the cheapest edges that don't share a position, until the target or the error limit is reached
+			while (result.size() > targetIndexCount)
+			{
+				size_t const triangleCount{ result.size() / 3 };
+
+				positionIndices.resize(result.size());
+				for (size_t i{ 0 }; i < result.size(); ++i)
+					positionIndices[i] = positionIds[result[i]];
+
+				edges.clear();
+				for (size_t t{ 0 }; t < triangleCount; ++t)
+				{
+					for (uint32_t k{ 0 }; k < 3; ++k)
+						edges.emplace_back(QEM::EdgeKey(positionIndices[t * 3 + k], positionIndices[t * 3 + (k + 1) % 3]));
+				}
+				std::sort(edges.begin(), edges.end());
+				edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+				collapses.clear();
+				for (uint64_t const edge : edges)
+				{
+					uint32_t const a{ static_cast<uint32_t>(edge >> 32) };
+					uint32_t const b{ static_cast<uint32_t>(edge) };
+
+					float const errorToA{ collapseError(b, a) };
+					float const errorToB{ collapseError(a, b) };
+					if (errorToA < errorToB)
+						collapses.emplace_back(QEM::Collapse{ b, a, errorToA });
+					else
+						collapses.emplace_back(QEM::Collapse{ a, b, errorToB });
+				}
+				std::sort(collapses.begin(), collapses.end(), [](QEM::Collapse const& lhs, QEM::Collapse const& rhs) { return lhs.error < rhs.error; });
+
+				TriangleAdjacency const adjacency{ BuildTriangleAdjacency(positionIndices, positionCount) };
+
+				std::iota(positionRemap.begin(), positionRemap.end(), 0);
+				std::fill(isTouched.begin(), isTouched.end(), false);
+
+				//A collapse removes ~2 triangles, collapses far past the amount needed for the target are left for the next pass
+				//so they are re-evaluated after the cheap ones were done
+				size_t const targetTriangleCount{ targetIndexCount / 3 };
+				size_t const goalIdx{ std::min((triangleCount - targetTriangleCount) / 2, collapses.size() - 1) };
+				float const passError{ std::min(collapses[goalIdx].error * QEM::PassErrorScale, targetError) };
+
+				size_t trianglesLeft{ triangleCount };
+				size_t collapseCount{ 0 };
+				for (QEM::Collapse const& collapse : collapses)
+				{
+					if (collapse.error > passError || trianglesLeft <= targetTriangleCount)
+						break;
+
+					if (isTouched[collapse.from] || isTouched[collapse.to])
+						continue;
+
+					//Reject collapses that flip a remaining triangle around the moved position
+					bool isFlipping{ false };
+					uint32_t removedTriangles{ 0 };
+					for (uint32_t a{ adjacency.offsets[collapse.from] }; a < adjacency.offsets[collapse.from + 1] && !isFlipping; ++a)
+					{
+						uint32_t const* pTriangle{ &positionIndices[adjacency.triangles[a] * 3] };
+						if (pTriangle[0] == collapse.to || pTriangle[1] == collapse.to || pTriangle[2] == collapse.to)
+						{
+							++removedTriangles;
+							continue;
+						}
+
+						Vector3 p[3]{ positions[pTriangle[0]], positions[pTriangle[1]], positions[pTriangle[2]] };
+						Vector3 const normalBefore{ Vector3::Cross(p[1] - p[0], p[2] - p[0]) };
+						for (uint32_t k{ 0 }; k < 3; ++k)
+						{
+							if (pTriangle[k] == collapse.from)
+								p[k] = positions[collapse.to];
+						}
+						Vector3 const normalAfter{ Vector3::Cross(p[1] - p[0], p[2] - p[0]) };
+
+						isFlipping = Vector3::Dot(normalBefore, normalAfter) <= 0.f;
+					}
+
+					if (isFlipping)
+						continue;
+
+					positionRemap[collapse.from] = collapse.to;
+					quadrics[collapse.to] += quadrics[collapse.from];
+					isTouched[collapse.from] = true;
+					isTouched[collapse.to] = true;
+
+					resultError = std::max(resultError, collapse.error);
+					trianglesLeft -= std::min<size_t>(removedTriangles, trianglesLeft);
+					++collapseCount;
+				}
+
+				if (collapseCount == 0)
+					break;
+
+				//A collapsed vertex continues in the vertex it shares a triangle with, so attributes stay continuous inside a uv/normal wedge
+				for (uint32_t v{ 0 }; v < vertices.size(); ++v)
+					vertexRemap[v] = positionRemap[positionIds[v]] == positionIds[v] ? v : unassigned;
+
+				for (size_t i{ 0 }; i < result.size(); ++i)
+				{
+					uint32_t const v{ result[i] };
+					if (vertexRemap[v] != unassigned)
+						continue;
+
+					size_t const first{ i - i % 3 };
+					for (size_t j{ first }; j < first + 3; ++j)
+					{
+						if (positionIds[result[j]] == positionRemap[positionIds[v]])
+						{
+							vertexRemap[v] = result[j];
+							break;
+						}
+					}
+				}
+
+				//The wedge doesn't touch the collapsed edge, continue in the vertex with the closest attributes
+				for (uint32_t const v : result)
+				{
+					if (vertexRemap[v] != unassigned)
+						continue;
+
+					uint32_t const target{ positionRemap[positionIds[v]] };
+					float bestDistance{ FLT_MAX };
+					for (uint32_t i{ positionVertexOffsets[target] }; i < positionVertexOffsets[target + 1]; ++i)
+					{
+						Vertex const& candidate{ vertices[positionVertices[i]] };
+						float const distance{ (candidate.uv - vertices[v].uv).SqrMagnitude() + 1.f - Vector3::Dot(candidate.normal, vertices[v].normal) };
+						if (distance < bestDistance)
+						{
+							bestDistance = distance;
+							vertexRemap[v] = positionVertices[i];
+						}
+					}
+				}
+
+				//Triangles that lost an edge (or collapsed onto one position through a seam) are removed
+				size_t writeIdx{ 0 };
+				for (size_t t{ 0 }; t < triangleCount; ++t)
+				{
+					uint32_t const v0{ vertexRemap[result[t * 3]] };
+					uint32_t const v1{ vertexRemap[result[t * 3 + 1]] };
+					uint32_t const v2{ vertexRemap[result[t * 3 + 2]] };
+					if (positionIds[v0] == positionIds[v1] || positionIds[v1] == positionIds[v2] || positionIds[v2] == positionIds[v0])
+						continue;
+
+					result[writeIdx++] = v0;
+					result[writeIdx++] = v1;
+					result[writeIdx++] = v2;
+				}
+				result.resize(writeIdx);
+			}
+
+			if (pResultError)
+				*pResultError = resultError;
+
+			return result;
+		}
+
+		void BuildLODs(MeshData& mesh, uint32_t maxLevels)
+		{
+			mesh.lods.clear();
+
+			if (mesh.primitiveTopology != PrimitiveTopology::TriangleList || mesh.indices.empty())
+				return;
+
+			//Levels are simplified from the previous one, so a level's error is the sum of the errors before it
+			float const maxError{ mesh.boundingSphere.radius * MaxLODError };
+			mesh.lods.reserve(maxLevels);
+
+			std::vector<uint32_t> const* pSource{ &mesh.indices };
+			float sourceError{ 0.f };
+			for (uint32_t level{ 0 }; level < maxLevels; ++level)
+			{
+				size_t const targetIndexCount{ static_cast<size_t>(pSource->size() / 3 * LODReduction) * 3 };
+
+				float error{};
+				MeshLOD lod{};
+				lod.indices = Simplify(mesh.vertices, *pSource, targetIndexCount, maxError - sourceError, &error);
+
+				//Stop once the error limit doesn't allow a meaningful reduction anymore
+				if (lod.indices.empty() || lod.indices.size() > pSource->size() * LODMinReduction)
+					break;
+
+				OptimizeVertexCache(lod.indices, mesh.vertices.size());
+				lod.error = sourceError + error;
+
+				std::vector<bool> isUsed(mesh.vertices.size(), false);
+				for (uint32_t const index : lod.indices)
+				{
+					if (isUsed[index])
+						continue;
+
+					isUsed[index] = true;
+					lod.vertices.emplace_back(index);
+				}
+
+				mesh.lods.emplace_back(std::move(lod));
+				pSource = &mesh.lods.back().indices;
+				sourceError = mesh.lods.back().error;
+			}
+		}
+	}
+}
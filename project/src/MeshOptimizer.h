@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dae
+{
+	struct MeshData;
+	struct Vertex;
+
+	namespace MeshOptimizer
+	{
+		//Defaults stay below the usual 64 vertices / 126 triangles hardware meshlet limits
+		constexpr uint32_t MaxMeshletVertices{ 64 };
+		constexpr uint32_t MaxMeshletTriangles{ 124 };
+
+		/**
+		 * Greedily grows meshlets over shared vertices, preferring triangles that keep the normal cone narrow,
+		 * and calculates their bounding sphere and normal cone.
+		 * The triangles of the mesh are reordered so every meshlet is a contiguous range of MeshData::indices.
+		 * Does nothing for triangle strips.
+		 * \param mesh Mesh to partition, fills MeshData::meshlets and MeshData::meshletVertices
+		 * \param maxVertices Maximum amount of unique vertices per meshlet
+		 * \param maxTriangles Maximum amount of triangles per meshlet
+		 */
+		void BuildMeshlets(MeshData& mesh, uint32_t maxVertices = MaxMeshletVertices, uint32_t maxTriangles = MaxMeshletTriangles);
+
+		//Cache size the optimizer scores for and the default size ACMR is measured with
+		constexpr uint32_t VertexCacheSize{ 32 };
+
+		/**
+		 * Average Cache Miss Ratio, transformed vertices per triangle for a FIFO post-transform cache.
+		 * 3 is the worst case, ~0.5 is the best case for regular grids.
+		 * \param indices Triangle list
+		 * \param vertexCount Amount of vertices referenced by the indices
+		 * \param cacheSize Amount of entries in the simulated cache
+		 */
+		[[nodiscard]] float CalculateACMR(std::vector<uint32_t> const& indices, size_t vertexCount, uint32_t cacheSize = VertexCacheSize);
+
+		/**
+		 * Reorders the triangles of a triangle list for post-transform vertex cache locality
+		 * using Tom Forsyth's linear-speed vertex cache optimization.
+		 * \param indices Triangle list, reordered in place
+		 * \param vertexCount Amount of vertices referenced by the indices
+		 */
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+		/**
+		 * Reorders the vertices in the order they are first referenced by the indices and remaps the indices.
+		 * Unreferenced vertices are removed.
+		 */
+		void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+		//Every level targets this fraction of the previous level's triangles
+		constexpr float LODReduction{ .5f };
+		//Levels that can't get below this fraction of the previous level are not kept
+		constexpr float LODMinReduction{ .85f };
+		//Simplification error limit relative to the bounding sphere radius
+		constexpr float MaxLODError{ .05f };
+		constexpr uint32_t MaxLODCount{ 4 };
+
+		/**
+		 * Quadric error metric edge collapse simplification (Garland & Heckbert) of a triangle list.
+		 * Only the indices are changed, collapsed vertices continue in a vertex at the target position,
+		 * preferring the one on the same side of a uv/normal seam. Borders are constrained, not locked.
+		 * \param vertices Vertices referenced by the indices
+		 * \param indices Triangle list to simplify
+		 * \param targetIndexCount Amount of indices to stop at
+		 * \param targetError Maximum object space distance a collapse may move the surface
+		 * \param pResultError Optional, receives the largest error of the performed collapses
+		 * \return Simplified triangle list
+		 */
+		[[nodiscard]] std::vector<uint32_t> Simplify(std::vector<Vertex> const& vertices, std::vector<uint32_t> const& indices, size_t targetIndexCount, float targetError, float* pResultError = nullptr);
+
+		/**
+		 * Builds a chain of simplified levels of detail, every level simplified from the previous one.
+		 * Requires the bounds of the mesh, the error limit scales with its bounding sphere.
+		 * \param mesh Mesh to simplify, fills MeshData::lods
+		 * \param maxLevels Maximum amount of levels next to the mesh itself
+		 */
+		void BuildLODs(MeshData& mesh, uint32_t maxLevels = MaxLODCount);
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+//Standard includes
+#include <array>
+#include <cstdint>
+#include <span>
+
+//Project includes
+#include "Vector2.h"
+
+namespace dae
+{
+	//Sample positions of multisample anti-aliasing
+	//The standard D3D patterns, rotated grids that give every sample a row and a column of its own
+	//so near horizontal and near vertical edges get as many coverage steps as there are samples, an ordered 2x2 grid only gets 2
+	namespace Multisample
+	{
+		uint32_t constexpr MaxSampleCount{ 8 };
+
+		constexpr bool IsSupported(uint32_t sampleCount) noexcept
+		{
+			return sampleCount == 1 || sampleCount == 2 || sampleCount == 4 || sampleCount == 8;
+		}
+
+		//Offsets from the top left corner of the pixel, a single sample is the pixel center
+		inline std::span<Vector2 const> GetSamplePositions(uint32_t sampleCount) noexcept
+		{
+			//in 16ths of a pixel from its center
+			auto constexpr toPosition{ [](float x, float y) { return Vector2{ .5f + x / 16.f, .5f + y / 16.f }; } };
+
+			static std::array<Vector2, 1> constexpr x1{ toPosition(0.f, 0.f) };
+			static std::array<Vector2, 2> constexpr x2{ toPosition(4.f, 4.f), toPosition(-4.f, -4.f) };
+			static std::array<Vector2, 4> constexpr x4{ toPosition(-2.f, -6.f), toPosition(6.f, -2.f), toPosition(-6.f, 2.f), toPosition(2.f, 6.f) };
+			static std::array<Vector2, 8> constexpr x8
+			{
+				toPosition(1.f, -3.f), toPosition(-1.f, 3.f), toPosition(5.f, 1.f), toPosition(-3.f, -5.f),
+				toPosition(-5.f, 5.f), toPosition(-7.f, -1.f), toPosition(3.f, 7.f), toPosition(7.f, -7.f)
+			};
+
+			switch (sampleCount)
+			{
+			case 2:
+				return x2;
+			case 4:
+				return x4;
+			case 8:
+				return x8;
+			default:
+				return x1;
+			}
+		}
+
+		//Per channel box filter of packed 8 bit pixels, whatever the channel layout
+		//Red and blue (or whatever sits in bytes 0 and 2) are summed in one word, green and alpha in another, 8 samples of 255 still fit 16 bits
+		inline uint32_t Resolve(uint32_t const* pSamples, uint32_t sampleCount, uint32_t sampleShift) noexcept
+		{
+			uint32_t evenBytes{ 0 };
+			uint32_t oddBytes{ 0 };
+			for (uint32_t s{ 0 }; s < sampleCount; ++s)
+			{
+				evenBytes += pSamples[s] & 0x00ff00ff;
+				oddBytes += (pSamples[s] >> 8) & 0x00ff00ff;
+			}
+
+			//rounded to the nearest value
+			uint32_t const rounding{ (sampleCount / 2) * 0x00010001u };
+			evenBytes = ((evenBytes + rounding) >> sampleShift) & 0x00ff00ff;
+			oddBytes = ((oddBytes + rounding) >> sampleShift) & 0x00ff00ff;
+			return evenBytes | oddBytes << 8;
+		}
+	}
+}
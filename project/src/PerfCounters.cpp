@@ -0,0 +1,109 @@
+#include "PerfCounters.h"
+
+#if defined(__linux__)
+//External includes
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace dae
+{
+#if defined(__linux__)
+	namespace
+	{
+		int OpenEvent(uint32_t type, uint64_t config, int groupFd) noexcept
+		{
+			perf_event_attr attr{};
+			attr.size = sizeof(perf_event_attr);
+			attr.type = type;
+			attr.config = config;
+			//the leader starts the whole group
+			attr.disabled = groupFd < 0 ? 1 : 0;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+
+			//this thread on any CPU, glibc has no wrapper
+			return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+		}
+	}
+
+	PerfCounters::PerfCounters()
+	{
+		struct Event
+		{
+			uint32_t type;
+			uint64_t config;
+		};
+		Event constexpr events[]
+		{
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+			{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+		};
+
+		for (size_t i{ 0 }; i < m_Fds.size(); ++i)
+		{
+			m_Fds[i] = OpenEvent(events[i].type, events[i].config, m_GroupFd);
+			if (m_Fds[i] < 0)
+			{
+				//without cycles there is nothing to read the group through
+				if (i == 0)
+					return;
+				continue;
+			}
+
+			if (i == 0)
+				m_GroupFd = m_Fds[0];
+			ioctl(m_Fds[i], PERF_EVENT_IOC_ID, &m_Ids[i]);
+		}
+
+		ioctl(m_GroupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(m_GroupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+
+	PerfCounters::~PerfCounters()
+	{
+		for (int const fd : m_Fds)
+		{
+			if (fd >= 0)
+				close(fd);
+		}
+	}
+
+	PerfCounterValues PerfCounters::Read() const noexcept
+	{
+		if (m_GroupFd < 0)
+			return {};
+
+		//{ nr, { value, id } * nr }
+		uint64_t buffer[1 + 2 * 5]{};
+		if (read(m_GroupFd, buffer, sizeof(buffer)) <= 0)
+			return {};
+
+		std::array<uint64_t, 5> counts{};
+		for (uint64_t i{ 0 }; i < buffer[0] && i < 5; ++i)
+		{
+			for (size_t event{ 0 }; event < m_Ids.size(); ++event)
+			{
+				if (m_Fds[event] >= 0 && m_Ids[event] == buffer[2 + i * 2])
+					counts[event] = buffer[1 + i * 2];
+			}
+		}
+
+		return { counts[0], counts[1], counts[2], counts[3], counts[4] };
+	}
+#else
+	PerfCounters::PerfCounters() = default;
+	PerfCounters::~PerfCounters() = default;
+
+	PerfCounterValues PerfCounters::Read() const noexcept
+	{
+		return {};
+	}
+#endif
+}
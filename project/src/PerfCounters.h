@@ -0,0 +1,66 @@
+#pragma once
+
+//Standard includes
+#include <array>
+#include <cstdint>
+
+namespace dae
+{
+	//Hardware events counted over a stretch of code
+	struct PerfCounterValues
+	{
+		uint64_t cycles{};
+		uint64_t instructions{};
+		uint64_t l1DataMisses{};
+		uint64_t lastLevelMisses{};
+		uint64_t branchMisses{};
+
+		//Instructions per cycle, low when the core waits on memory or recovers from mispredicted branches
+		double GetIPC() const noexcept { return cycles ? static_cast<double>(instructions) / cycles : 0.; }
+
+		PerfCounterValues& operator+=(PerfCounterValues const& other) noexcept
+		{
+			cycles += other.cycles;
+			instructions += other.instructions;
+			l1DataMisses += other.l1DataMisses;
+			lastLevelMisses += other.lastLevelMisses;
+			branchMisses += other.branchMisses;
+			return *this;
+		}
+		PerfCounterValues operator-(PerfCounterValues const& other) const noexcept
+		{
+			return { cycles - other.cycles, instructions - other.instructions, l1DataMisses - other.l1DataMisses,
+				lastLevelMisses - other.lastLevelMisses, branchMisses - other.branchMisses };
+		}
+	};
+
+	//CPU performance counters of the thread that creates it, through perf_event_open on Linux
+	//Only user space is counted, which works with the default perf_event_paranoid of 2
+	//Unavailable on other platforms, in most virtual machines and when the kernel refuses, Read then returns zeros
+	class PerfCounters final
+	{
+	public:
+		PerfCounters();
+		~PerfCounters();
+
+		PerfCounters(const PerfCounters&) = delete;
+		PerfCounters(PerfCounters&&) noexcept = delete;
+		PerfCounters& operator=(const PerfCounters&) = delete;
+		PerfCounters& operator=(PerfCounters&&) noexcept = delete;
+
+		//At least the cycle counter could be opened, events the CPU doesn't have stay zero
+		bool IsAvailable() const noexcept { return m_GroupFd >= 0; }
+
+		//Totals since the counters were opened, the difference of two reads is the cost of the code between them
+		//Has to be called from the thread that created the counters
+		PerfCounterValues Read() const noexcept;
+
+	private:
+		//cycles, instructions, L1 data misses, last level misses and branch misses, -1 when not opened
+		//read together through the cycle counter, the leader of the group
+		std::array<int, 5> m_Fds{ -1, -1, -1, -1, -1 };
+		//identify the values of a group read, events that couldn't be opened are left out of it
+		std::array<uint64_t, 5> m_Ids{};
+		int m_GroupFd{ -1 };
+	};
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "SDL_pixels.h"
+
+#include "ColorRGB.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXELPACKER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace dae
+{
+	//Channel layout of a 32 bit pixel format with 8 bit channels, resolved once so packing a color doesn't call into SDL
+	//Produces the same pixels as SDL_MapRGB with the channels scaled to 255 and truncated
+	class PixelPacker final
+	{
+	public:
+		//ARGB8888, the format of every RenderTarget
+		PixelPacker() = default;
+
+		explicit PixelPacker(SDL_PixelFormat const* pFormat)
+		{
+			m_AlphaMask = pFormat->Amask;
+
+			//lane of the packed pixel each channel ends up in, lanes without a color channel stay 0
+			m_LaneChannels = { NoChannel, NoChannel, NoChannel, NoChannel };
+			m_LaneChannels[pFormat->Rshift / 8] = 0;
+			m_LaneChannels[pFormat->Gshift / 8] = 1;
+			m_LaneChannels[pFormat->Bshift / 8] = 2;
+		}
+
+		uint32_t Pack(uint8_t r, uint8_t g, uint8_t b) const noexcept
+		{
+			uint8_t const channels[4]{ r, g, b, 0 };
+			return m_AlphaMask
+				| static_cast<uint32_t>(channels[m_LaneChannels[0]])
+				| static_cast<uint32_t>(channels[m_LaneChannels[1]]) << 8
+				| static_cast<uint32_t>(channels[m_LaneChannels[2]]) << 16
+				| static_cast<uint32_t>(channels[m_LaneChannels[3]]) << 24;
+		}
+
+		//Applies ColorRGB::MaxToOne, saturates to [0, 1] and packs the result
+		uint32_t Pack(ColorRGB const& color) const noexcept
+		{
+			float const channels[4]{ color.r, color.g, color.b, 0.f };
+
+#ifdef PIXELPACKER_SSE2
+			__m128 c{ _mm_setr_ps(channels[m_LaneChannels[0]], channels[m_LaneChannels[1]], channels[m_LaneChannels[2]], channels[m_LaneChannels[3]]) };
+
+			//broadcast the largest channel, the empty lane is 0 and can't change the outcome of dividing by max(maxValue, 1)
+			__m128 maxValue{ _mm_max_ps(c, _mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 3, 0, 1))) };
+			maxValue = _mm_max_ps(maxValue, _mm_shuffle_ps(maxValue, maxValue, _MM_SHUFFLE(1, 0, 3, 2)));
+			c = _mm_div_ps(c, _mm_max_ps(maxValue, _mm_set1_ps(1.f)));
+
+			c = _mm_min_ps(_mm_max_ps(c, _mm_setzero_ps()), _mm_set1_ps(1.f));
+			__m128i const channels32{ _mm_cvttps_epi32(_mm_mul_ps(c, _mm_set1_ps(255.f))) };
+
+			//32 -> 16 -> 8 bit per lane, lane i is byte i of the pixel
+			__m128i const channels16{ _mm_packs_epi32(channels32, channels32) };
+			return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(channels16, channels16))) | m_AlphaMask;
+#else
+			float const maxValue{ std::max(1.f, std::max(color.r, std::max(color.g, color.b))) };
+
+			uint32_t pixel{ m_AlphaMask };
+			for (uint32_t lane{ 0 }; lane < 4; ++lane)
+			{
+				float const channel{ std::clamp(channels[m_LaneChannels[lane]] / maxValue, 0.f, 1.f) };
+				pixel |= static_cast<uint32_t>(channel * 255.f) << (lane * 8);
+			}
+			return pixel;
+#endif
+		}
+
+	private:
+		//index of the 0 in the channel arrays
+		static uint8_t constexpr NoChannel{ 3 };
+
+		//color channel (r, g, b) stored in each byte of the pixel, lowest byte first
+		std::array<uint8_t, 4> m_LaneChannels{ 2, 1, 0, NoChannel };
+		uint32_t m_AlphaMask{ 0xff000000 };
+	};
+}
@@ -0,0 +1,120 @@
+#include "Profiler.h"
+
+//Standard includes
+#include <algorithm>
+#include <fstream>
+
+namespace dae
+{
+	void Profiler::SetThreadName(std::string name)
+	{
+		//Without zones there is no track to name, and no reason to allocate a buffer
+		if constexpr (!IsEnabled())
+			return;
+
+		ThreadBuffer& buffer{ GetThreadBuffer() };
+
+		std::lock_guard const lock{ s_Mutex };
+		buffer.name = std::move(name);
+	}
+
+	void Profiler::Record(char const* name, int64_t start, int64_t end) noexcept
+	{
+		ThreadBuffer& buffer{ GetThreadBuffer() };
+
+		uint64_t const head{ buffer.head.load(std::memory_order_relaxed) };
+		ZoneSlot& slot{ buffer.pZones[head % ThreadBuffer::Capacity] };
+
+		//A reader that sees any field of the new zone also sees the head it was written at, and drops the zone it overwrote
+		slot.name.store(name, std::memory_order_release);
+		slot.start.store(start, std::memory_order_release);
+		slot.end.store(end, std::memory_order_release);
+		buffer.head.store(head + 1, std::memory_order_release);
+	}
+
+	bool Profiler::WriteChromeTrace(std::filesystem::path const& path)
+	{
+		std::ofstream file{ path };
+		if (!file)
+			return false;
+
+		//Names are literals from the source, only quotes and backslashes need escaping
+		auto const writeString{ [&file](char const* pString)
+		{
+			file << '"';
+			for (; *pString; ++pString)
+			{
+				if (*pString == '"' || *pString == '\\')
+					file << '\\';
+				file << *pString;
+			}
+			file << '"';
+		} };
+
+		std::lock_guard const lock{ s_Mutex };
+
+		file << "{\"traceEvents\":[";
+		bool isFirst{ true };
+		std::vector<Zone> zones{};
+		for (auto const& pBuffer : s_pBuffers)
+		{
+			file << (isFirst ? "\n" : ",\n");
+			isFirst = false;
+
+			std::string const name{ pBuffer->name.empty() ? "Thread " + std::to_string(pBuffer->threadIdx) : pBuffer->name };
+			file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << pBuffer->threadIdx << ",\"args\":{\"name\":";
+			writeString(name.c_str());
+			file << "}}";
+
+			//Copied first, the thread keeps recording while the trace is written
+			uint64_t const head{ pBuffer->head.load(std::memory_order_acquire) };
+			uint64_t const count{ std::min<uint64_t>(head, ThreadBuffer::Capacity) };
+			zones.clear();
+			for (uint64_t i{ head - count }; i < head; ++i)
+			{
+				ZoneSlot const& slot{ pBuffer->pZones[i % ThreadBuffer::Capacity] };
+				zones.emplace_back(Zone{ slot.name.load(std::memory_order_acquire), slot.start.load(std::memory_order_acquire), slot.end.load(std::memory_order_acquire) });
+			}
+
+			//Zones the thread wrapped around to since, including the one it may be writing right now at the new head, can be mixed from two zones
+			uint64_t const newHead{ pBuffer->head.load(std::memory_order_acquire) };
+			uint64_t const firstValid{ newHead >= ThreadBuffer::Capacity ? newHead - ThreadBuffer::Capacity + 1 : 0 };
+			size_t const skipped{ static_cast<size_t>(std::min<uint64_t>(firstValid - std::min(firstValid, head - count), count)) };
+
+			//Complete events, timestamps and durations in microseconds
+			for (size_t i{ skipped }; i < zones.size(); ++i)
+			{
+				Zone const& zone{ zones[i] };
+
+				file << ",\n{\"name\":";
+				writeString(zone.name);
+				file << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << pBuffer->threadIdx
+					<< ",\"ts\":" << zone.start / 1000. << ",\"dur\":" << (zone.end - zone.start) / 1000. << '}';
+			}
+		}
+		file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+		return static_cast<bool>(file);
+	}
+
+	void Profiler::Clear()
+	{
+		std::lock_guard const lock{ s_Mutex };
+		for (auto const& pBuffer : s_pBuffers)
+			pBuffer->head.store(0, std::memory_order_relaxed);
+	}
+
+	Profiler::ThreadBuffer& Profiler::GetThreadBuffer()
+	{
+		thread_local ThreadBuffer* pBuffer{ nullptr };
+		if (pBuffer)
+			return *pBuffer;
+
+		std::lock_guard const lock{ s_Mutex };
+		auto& pNewBuffer{ s_pBuffers.emplace_back(std::make_unique<ThreadBuffer>()) };
+		pNewBuffer->threadIdx = static_cast<uint32_t>(s_pBuffers.size() - 1);
+
+		pBuffer = pNewBuffer.get();
+		return *pBuffer;
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+//Standard includes
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Scoped zones, recorded per thread and written as a Chrome trace (chrome://tracing or ui.perfetto.dev)
+//Configure with ENABLE_PROFILER to record them, without it PROFILE_SCOPE expands to nothing
+#ifdef ENABLE_PROFILER
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+//name has to be a string literal, only the pointer is stored
+#define PROFILE_SCOPE(name) dae::ProfileScope const PROFILE_CONCAT(profileScope, __LINE__){ name }
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+namespace dae
+{
+	class Profiler final
+	{
+	public:
+		struct Zone
+		{
+			char const* name{};
+			//nanoseconds since the profiler started
+			int64_t start{};
+			int64_t end{};
+		};
+
+		static constexpr bool IsEnabled() noexcept
+		{
+#ifdef ENABLE_PROFILER
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		//Shown as the name of the calling thread's track in the trace
+		static void SetThreadName(std::string name);
+
+		static void Record(char const* name, int64_t start, int64_t end) noexcept;
+		static int64_t Now() noexcept
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_StartTime).count();
+		}
+
+		//Writes the most recent zones of every thread, zones recorded while writing may be missing
+		static bool WriteChromeTrace(std::filesystem::path const& path);
+		//Forgets every zone, only while no zones are recorded
+		static void Clear();
+
+	private:
+		//A zone in the ring, its thread may overwrite it while it's read
+		//Atomic fields make that a stale or mixed value instead of a data race, the reader drops such zones
+		struct ZoneSlot
+		{
+			std::atomic<char const*> name{};
+			std::atomic<int64_t> start{};
+			std::atomic<int64_t> end{};
+		};
+
+		//Zones of one thread, a ring that overwrites the oldest zones once it's full
+		//Only its thread writes, the head is published after the zone so a reader never sees a zone before it's complete
+		//Like a seqlock, a reader loads the head again after copying zones and drops the ones that may have been overwritten meanwhile
+		struct ThreadBuffer
+		{
+			static constexpr uint32_t Capacity{ 1 << 16 };
+
+			std::unique_ptr<ZoneSlot[]> pZones{ std::make_unique<ZoneSlot[]>(Capacity) };
+			std::atomic<uint64_t> head{ 0 };
+			uint32_t threadIdx{};
+			std::string name{};
+		};
+
+		inline static std::chrono::steady_clock::time_point const s_StartTime{ std::chrono::steady_clock::now() };
+
+		//Buffers outlive their threads so zones of finished workers can still be written
+		inline static std::mutex s_Mutex{};
+		inline static std::vector<std::unique_ptr<ThreadBuffer>> s_pBuffers{};
+
+		//Registers the buffer of the calling thread the first time it records
+		static ThreadBuffer& GetThreadBuffer();
+	};
+
+	class ProfileScope final
+	{
+	public:
+		explicit ProfileScope(char const* name) noexcept :
+			m_Name{ name },
+			m_Start{ Profiler::Now() }
+		{
+		}
+		~ProfileScope()
+		{
+			Profiler::Record(m_Name, m_Start, Profiler::Now());
+		}
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope(ProfileScope&&) noexcept = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+		ProfileScope& operator=(ProfileScope&&) noexcept = delete;
+
+	private:
+		char const* m_Name;
+		int64_t m_Start;
+	};
+}
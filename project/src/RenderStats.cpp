@@ -0,0 +1,76 @@
+#include "RenderStats.h"
+
+//Standard includes
+#include <algorithm>
+#include <ostream>
+
+namespace dae
+{
+	RenderStats& RenderStats::operator+=(RenderStats const& other) noexcept
+	{
+		verticesTransformed += other.verticesTransformed;
+		trianglesClipped += other.trianglesClipped;
+		trianglesBackFacing += other.trianglesBackFacing;
+		trianglesZeroArea += other.trianglesZeroArea;
+		trianglesFrustumCulled += other.trianglesFrustumCulled;
+		trianglesOccluded += other.trianglesOccluded;
+		trianglesRasterized += other.trianglesRasterized;
+		pixelsTested += other.pixelsTested;
+		pixelsPassed += other.pixelsPassed;
+		pixelsShaded += other.pixelsShaded;
+		pixelsCovered += other.pixelsCovered;
+		textureFetches += other.textureFetches;
+		sampleColorBytes += other.sampleColorBytes;
+		cullMs += other.cullMs;
+		transformMs += other.transformMs;
+		rasterizeMs += other.rasterizeMs;
+		clearMs += other.clearMs;
+		resolveMs += other.resolveMs;
+		presentMs += other.presentMs;
+		frameMs += other.frameMs;
+		cullCounters += other.cullCounters;
+		transformCounters += other.transformCounters;
+		rasterizeCounters += other.rasterizeCounters;
+		clearCounters += other.clearCounters;
+		resolveCounters += other.resolveCounters;
+		presentCounters += other.presentCounters;
+		frameCounters += other.frameCounters;
+		return *this;
+	}
+
+	void RenderStats::Print(std::ostream& os, uint64_t frameCount) const
+	{
+		frameCount = std::max<uint64_t>(frameCount, 1);
+
+		os << "Vertices: " << verticesTransformed / frameCount << " transformed\n"
+			<< "Triangles: " << GetTrianglesSubmitted() / frameCount << " submitted, " << trianglesRasterized / frameCount << " rasterized, "
+			<< GetTrianglesCulled() / frameCount << " culled (clip " << trianglesClipped / frameCount
+			<< ", back-face " << trianglesBackFacing / frameCount
+			<< ", zero area " << trianglesZeroArea / frameCount
+			<< ", frustum " << trianglesFrustumCulled / frameCount
+			<< ", occluded " << trianglesOccluded / frameCount << ")\n"
+			<< "Pixels: " << pixelsTested / frameCount << " tested, " << pixelsPassed / frameCount << " passed depth, "
+			<< pixelsShaded / frameCount << " shaded, " << pixelsCovered / frameCount << " covered - overdraw " << GetOverdraw() << '\n'
+			<< "Texture fetches: " << textureFetches / frameCount << '\n';
+		if (sampleColorBytes)
+			os << "Sample colors: " << sampleColorBytes / (1024. * 1024.) / frameCount << " MB cleared, written and resolved\n";
+		os << "Stages: cull " << cullMs / frameCount << "ms, transform " << transformMs / frameCount
+			<< "ms, rasterize " << rasterizeMs / frameCount << "ms, clear " << clearMs / frameCount
+			<< "ms, resolve " << resolveMs / frameCount << "ms, present " << presentMs / frameCount << "ms - frame " << frameMs / frameCount << "ms\n";
+
+		if (!HasCounters())
+			return;
+
+		auto const perItem{ [](uint64_t count, uint64_t items) { return items ? static_cast<double>(count) / items : 0.; } };
+		os << "IPC: cull " << cullCounters.GetIPC() << ", transform " << transformCounters.GetIPC() << ", rasterize " << rasterizeCounters.GetIPC()
+			<< ", clear " << clearCounters.GetIPC() << ", resolve " << resolveCounters.GetIPC() << ", present " << presentCounters.GetIPC() << " - frame " << frameCounters.GetIPC() << '\n'
+			<< "Per vertex: " << perItem(transformCounters.cycles, verticesTransformed) << " cycles, "
+			<< perItem(transformCounters.l1DataMisses, verticesTransformed) << " L1 misses, "
+			<< perItem(transformCounters.lastLevelMisses, verticesTransformed) << " LLC misses, "
+			<< perItem(transformCounters.branchMisses, verticesTransformed) << " branch misses\n"
+			<< "Per pixel: " << perItem(rasterizeCounters.cycles, pixelsTested) << " cycles, "
+			<< perItem(rasterizeCounters.l1DataMisses, pixelsTested) << " L1 misses, "
+			<< perItem(rasterizeCounters.lastLevelMisses, pixelsTested) << " LLC misses, "
+			<< perItem(rasterizeCounters.branchMisses, pixelsTested) << " branch misses\n";
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+#include <iosfwd>
+
+//Project includes
+#include "PerfCounters.h"
+
+namespace dae
+{
+	//Workload of a frame and the time spent on it, every renderer counts its own so threads never share counters
+	struct RenderStats
+	{
+		uint64_t verticesTransformed{};
+
+		//Triangles culled before rasterization, by reason
+		//a vertex outside the view in x or y
+		uint64_t trianglesClipped{};
+		//facing away, per triangle or per meshlet through its normal cone
+		uint64_t trianglesBackFacing{};
+		//degenerate, repeated indices or no area on screen
+		uint64_t trianglesZeroArea{};
+		//outside the view frustum, per mesh or per meshlet
+		uint64_t trianglesFrustumCulled{};
+		//meshlets behind the HiZ
+		uint64_t trianglesOccluded{};
+		uint64_t trianglesRasterized{};
+
+		//pixels inside a triangle, the ones passing the depth test are shaded
+		uint64_t pixelsTested{};
+		uint64_t pixelsPassed{};
+		uint64_t pixelsShaded{};
+		//pixels with geometry at the end of the frame, partly covered pixels of multisampling count for the fraction of their samples covered
+		uint64_t pixelsCovered{};
+		uint64_t textureFetches{};
+		//multisampled colors cleared, written and read by the resolve, zero without multisampling
+		uint64_t sampleColorBytes{};
+
+		//Milliseconds per stage, rasterizing includes shading and clearing the bands it touches
+		double cullMs{};
+		double transformMs{};
+		double rasterizeMs{};
+		double clearMs{};
+		//averaging the samples into the back buffer
+		double resolveMs{};
+		double presentMs{};
+		double frameMs{};
+
+		//Hardware counters of the same stages, zero unless the renderer counts them (Renderer::EnablePerfCounters)
+		PerfCounterValues cullCounters{};
+		PerfCounterValues transformCounters{};
+		PerfCounterValues rasterizeCounters{};
+		PerfCounterValues clearCounters{};
+		PerfCounterValues resolveCounters{};
+		PerfCounterValues presentCounters{};
+		PerfCounterValues frameCounters{};
+
+		uint64_t GetTrianglesCulled() const noexcept
+		{
+			return trianglesClipped + trianglesBackFacing + trianglesZeroArea + trianglesFrustumCulled + trianglesOccluded;
+		}
+		uint64_t GetTrianglesSubmitted() const noexcept { return GetTrianglesCulled() + trianglesRasterized; }
+		//Shaded pixels per covered pixel, 1 when nothing was shaded and later hidden
+		float GetOverdraw() const noexcept { return pixelsCovered ? static_cast<float>(pixelsShaded) / pixelsCovered : 0.f; }
+		bool HasCounters() const noexcept { return frameCounters.cycles > 0; }
+
+		RenderStats& operator+=(RenderStats const& other) noexcept;
+
+		//One line per group, the counters divided by frameCount
+		//Hardware counters are reported per vertex for transforming and per tested pixel for rasterizing
+		void Print(std::ostream& os, uint64_t frameCount = 1) const;
+	};
+}
@@ -0,0 +1,203 @@
+#include "RenderTarget.h"
+#include "Profiler.h"
+
+#include "SDL.h"
+#include "SDL_surface.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace dae
+{
+	RenderTarget::RenderTarget(int width, int height, uint32_t bufferCount) :
+		m_Width{ width },
+		m_Height{ height },
+		m_Buffers(std::max(bufferCount, 1u), std::vector<uint32_t>(static_cast<size_t>(width) * height, 0)),
+		m_pFormat{ SDL_AllocFormat(SDL_PIXELFORMAT_ARGB8888) }
+	{
+		assert(width > 0 && height > 0);
+	}
+
+	RenderTarget::~RenderTarget()
+	{
+		SDL_FreeFormat(m_pFormat);
+	}
+
+	void RenderTarget::SwapBuffers() noexcept
+	{
+		m_FrontBufferIdx = m_BackBufferIdx;
+		m_BackBufferIdx = (m_BackBufferIdx + 1) % m_Buffers.size();
+	}
+
+	SDL_Surface* RenderTarget::CreateSurface(size_t bufferIdx) const
+	{
+		//SDL doesn't write through a const surface, the cast only satisfies the signature
+		SDL_Surface* pSurface{ SDL_CreateRGBSurfaceWithFormatFrom(const_cast<uint32_t*>(m_Buffers[bufferIdx].data()), m_Width, m_Height, 32,
+			m_Width * static_cast<int>(sizeof(uint32_t)), SDL_PIXELFORMAT_ARGB8888) };
+
+		//Alpha is always opaque, copying is cheaper than blending
+		if (pSurface)
+			SDL_SetSurfaceBlendMode(pSurface, SDL_BLENDMODE_NONE);
+
+		return pSurface;
+	}
+
+	WindowRenderTarget::WindowRenderTarget(SDL_Window* pWindow, uint32_t bufferCount) :
+		RenderTarget{ GetWindowWidth(pWindow), GetWindowHeight(pWindow), bufferCount },
+		m_pWindow{ pWindow }
+	{
+		m_pFrontBuffer = SDL_GetWindowSurface(pWindow);
+
+		m_pBackBuffers.reserve(GetBufferCount());
+		for (size_t i{ 0 }; i < GetBufferCount(); ++i)
+			m_pBackBuffers.emplace_back(CreateSurface(i));
+
+		//A single buffer can't be drawn into while it's presented, there is nothing to overlap
+		if (GetBufferCount() == 1)
+			return;
+
+		m_pConvertedBuffers.reserve(GetBufferCount());
+		for (size_t i{ 0 }; i < GetBufferCount(); ++i)
+		{
+			SDL_Surface* pConverted{ SDL_CreateRGBSurfaceWithFormat(0, GetWidth(), GetHeight(), m_pFrontBuffer->format->BitsPerPixel, m_pFrontBuffer->format->format) };
+			if (pConverted)
+				SDL_SetSurfaceBlendMode(pConverted, SDL_BLENDMODE_NONE);
+			m_pConvertedBuffers.emplace_back(pConverted);
+		}
+
+		m_PresentThread = std::thread{ &WindowRenderTarget::RunPresentThread, this };
+	}
+
+	WindowRenderTarget::~WindowRenderTarget()
+	{
+		if (m_PresentThread.joinable())
+		{
+			{
+				std::lock_guard const lock{ m_Mutex };
+				m_IsStopping = true;
+			}
+			m_BufferQueued.notify_one();
+			m_PresentThread.join();
+
+			ShowConvertedBuffers();
+		}
+
+		for (SDL_Surface* pBackBuffer : m_pBackBuffers)
+			SDL_FreeSurface(pBackBuffer);
+		for (SDL_Surface* pConverted : m_pConvertedBuffers)
+			SDL_FreeSurface(pConverted);
+	}
+
+	void WindowRenderTarget::Present()
+	{
+		if (!m_PresentThread.joinable())
+		{
+			ShowBuffer(m_pBackBuffers[GetBackBufferIndex()]);
+			SwapBuffers();
+			return;
+		}
+
+		{
+			std::lock_guard const lock{ m_Mutex };
+			m_ConvertQueue.emplace_back(GetBackBufferIndex());
+			++m_FramesInFlight;
+		}
+		m_BufferQueued.notify_one();
+
+		SwapBuffers();
+
+		//The new back buffer is the oldest of the ring, it's free once at most bufferCount - 1 frames are still in flight
+		//frames are only shown by this thread, so frames converted while waiting are shown here
+		while (true)
+		{
+			ShowConvertedBuffers();
+
+			std::unique_lock lock{ m_Mutex };
+			if (m_FramesInFlight < GetBufferCount())
+				return;
+
+			m_BufferConverted.wait(lock, [this]() { return !m_ShowQueue.empty(); });
+		}
+	}
+
+	void WindowRenderTarget::Refresh()
+	{
+		if (ShowConvertedBuffers())
+			return;
+
+		SDL_UpdateWindowSurface(m_pWindow);
+	}
+
+	void WindowRenderTarget::RunPresentThread()
+	{
+		Profiler::SetThreadName("Present");
+
+		while (true)
+		{
+			size_t bufferIdx{};
+			{
+				std::unique_lock lock{ m_Mutex };
+				m_BufferQueued.wait(lock, [this]() { return m_IsStopping || !m_ConvertQueue.empty(); });
+
+				//Frames that were already finished are still converted
+				if (m_ConvertQueue.empty())
+					return;
+
+				bufferIdx = m_ConvertQueue.front();
+				m_ConvertQueue.pop_front();
+			}
+
+			{
+				PROFILE_SCOPE("Convert");
+				//both surfaces are private to the target, the window isn't touched
+				SDL_BlitSurface(m_pBackBuffers[bufferIdx], 0, m_pConvertedBuffers[bufferIdx], 0);
+			}
+
+			{
+				std::lock_guard const lock{ m_Mutex };
+				m_ShowQueue.emplace_back(bufferIdx);
+			}
+			m_BufferConverted.notify_one();
+		}
+	}
+
+	bool WindowRenderTarget::ShowConvertedBuffers()
+	{
+		size_t bufferIdx{};
+		{
+			std::lock_guard const lock{ m_Mutex };
+			if (m_ShowQueue.empty())
+				return false;
+
+			bufferIdx = m_ShowQueue.back();
+			//Only the window thread queues frames, none of these buffers is reused before this returns
+			m_FramesInFlight -= static_cast<uint32_t>(m_ShowQueue.size());
+			m_ShowQueue.clear();
+		}
+
+		ShowBuffer(m_pConvertedBuffers[bufferIdx]);
+		return true;
+	}
+
+	void WindowRenderTarget::ShowBuffer(SDL_Surface* pBuffer)
+	{
+		PROFILE_SCOPE("Blit");
+
+		SDL_BlitSurface(pBuffer, 0, m_pFrontBuffer, 0);
+		SDL_UpdateWindowSurface(m_pWindow);
+	}
+
+	int WindowRenderTarget::GetWindowWidth(SDL_Window* pWindow)
+	{
+		int width{};
+		SDL_GetWindowSize(pWindow, &width, nullptr);
+		return width;
+	}
+
+	int WindowRenderTarget::GetWindowHeight(SDL_Window* pWindow)
+	{
+		int height{};
+		SDL_GetWindowSize(pWindow, nullptr, &height);
+		return height;
+	}
+}
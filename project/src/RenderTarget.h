@@ -0,0 +1,119 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct SDL_Window;
+struct SDL_Surface;
+struct SDL_PixelFormat;
+
+namespace dae
+{
+	//CPU color buffers the renderer draws into, pixels are ARGB8888
+	//With more than one buffer they form a ring: the next frame is drawn while the previous ones are still being presented
+	class RenderTarget
+	{
+	public:
+		virtual ~RenderTarget();
+
+		RenderTarget(const RenderTarget&) = delete;
+		RenderTarget(RenderTarget&&) noexcept = delete;
+		RenderTarget& operator=(const RenderTarget&) = delete;
+		RenderTarget& operator=(RenderTarget&&) noexcept = delete;
+
+		int GetWidth() const noexcept { return m_Width; }
+		int GetHeight() const noexcept { return m_Height; }
+		size_t GetBufferCount() const noexcept { return m_Buffers.size(); }
+
+		//The buffer the current frame is drawn into, changes after every Present when there is more than one
+		uint32_t* GetBackBuffer() noexcept { return m_Buffers[m_BackBufferIdx].data(); }
+		//The last presented frame, stays untouched until the ring comes back around to it
+		uint32_t const* GetPixels() const noexcept { return m_Buffers[m_FrontBufferIdx].data(); }
+
+		//Format of the pixels, allocated without the SDL video subsystem
+		SDL_PixelFormat const* GetFormat() const noexcept { return m_pFormat; }
+
+		//Called once a frame is finished, afterwards the back buffer is the next buffer of the ring
+		virtual void Present() { SwapBuffers(); }
+		//Shows the last presented frame again, nothing was drawn since
+		virtual void Refresh() {}
+
+	protected:
+		RenderTarget(int width, int height, uint32_t bufferCount = 1);
+
+		size_t GetBackBufferIndex() const noexcept { return m_BackBufferIdx; }
+		size_t GetFrontBufferIndex() const noexcept { return m_FrontBufferIdx; }
+
+		//The back buffer becomes the front buffer, drawing continues in the oldest buffer of the ring
+		void SwapBuffers() noexcept;
+
+		//Wraps the pixels of a buffer in a surface, they stay owned by the render target
+		SDL_Surface* CreateSurface(size_t bufferIdx) const;
+
+	private:
+		int m_Width{};
+		int m_Height{};
+		std::vector<std::vector<uint32_t>> m_Buffers{};
+		size_t m_BackBufferIdx{ 0 };
+		size_t m_FrontBufferIdx{ 0 };
+		SDL_PixelFormat* m_pFormat{ nullptr };
+	};
+
+	//Presents every frame to the surface of an SDL window
+	//Converting a frame to the pixel format of the window happens on a present thread, overlapping with drawing the next frame
+	//Copying into the window surface and updating the window stay on the thread that owns the window, SDL's video functions aren't thread safe
+	class WindowRenderTarget final : public RenderTarget
+	{
+	public:
+		//bufferCount 1 presents on the calling thread, 2 is double and 3 triple buffering
+		WindowRenderTarget(SDL_Window* pWindow, uint32_t bufferCount = 2);
+		//Converts and shows the frames that are still queued
+		~WindowRenderTarget() override;
+
+		//Both also show the frames converted since the last call, they have to be called from the thread that owns the window
+		void Present() override;
+		void Refresh() override;
+
+	private:
+		SDL_Window* m_pWindow{ nullptr };
+		SDL_Surface* m_pFrontBuffer{ nullptr };
+		//one per buffer of the ring
+		std::vector<SDL_Surface*> m_pBackBuffers{};
+		//one per buffer of the ring, in the pixel format of the window, written by the present thread only
+		std::vector<SDL_Surface*> m_pConvertedBuffers{};
+
+		std::mutex m_Mutex{};
+		//signaled when a buffer is queued or the target is destroyed
+		std::condition_variable m_BufferQueued{};
+		//signaled when a buffer is converted
+		std::condition_variable m_BufferConverted{};
+		std::deque<size_t> m_ConvertQueue{};
+		//converted, waiting for the window thread to show them
+		std::deque<size_t> m_ShowQueue{};
+		//from being queued until shown, a buffer and its converted copy are free again afterwards
+		uint32_t m_FramesInFlight{ 0 };
+		bool m_IsStopping{ false };
+
+		std::thread m_PresentThread{};
+
+		void RunPresentThread();
+		//Shows the newest converted frame, the older ones were never going to be seen. False when nothing was converted
+		bool ShowConvertedBuffers();
+		void ShowBuffer(SDL_Surface* pBuffer);
+
+		static int GetWindowWidth(SDL_Window* pWindow);
+		static int GetWindowHeight(SDL_Window* pWindow);
+	};
+
+	//Keeps frames in memory only, needs no window, display or SDL video subsystem
+	class OffscreenRenderTarget final : public RenderTarget
+	{
+	public:
+		OffscreenRenderTarget(int width, int height) :
+			RenderTarget{ width, height }
+		{}
+	};
+}
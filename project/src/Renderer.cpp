@@ -6,56 +6,239 @@
 #include "Renderer.h"
 #include "Renderer.h"
 #include "DataTypes.h"
+#include "Frustum.h"
+#include "MeshOptimizer.h"
+#include "Profiler.h"
+#include "RenderTarget.h"
 #include "BRDF.h"
 #include "Texture.h"
 #include "Utils.h"
 
+#include <array>
+#include <bit>
+#include <cassert>
+#include <chrono>
 #include <iostream>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RENDERER_STREAMING_STORES
+#endif
+
 using namespace dae;
 
-Renderer::Renderer(SDL_Window* pWindow) :
-	m_pWindow(pWindow)
+namespace
+{
+	//Adds the lifetime of the scope to a stage of RenderStats, and the hardware events of it when the renderer counts them
+	class StageTimer final
+	{
+	public:
+		StageTimer(double& milliseconds, PerfCounterValues& counters, PerfCounters const* pPerfCounters) noexcept :
+			m_Milliseconds{ milliseconds },
+			m_Counters{ counters },
+			m_pPerfCounters{ pPerfCounters },
+			m_StartCounters{ pPerfCounters ? pPerfCounters->Read() : PerfCounterValues{} },
+			m_Start{ std::chrono::steady_clock::now() }
+		{
+		}
+		~StageTimer()
+		{
+			m_Milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_Start).count();
+			if (m_pPerfCounters)
+				m_Counters += m_pPerfCounters->Read() - m_StartCounters;
+		}
+
+		StageTimer(const StageTimer&) = delete;
+		StageTimer(StageTimer&&) noexcept = delete;
+		StageTimer& operator=(const StageTimer&) = delete;
+		StageTimer& operator=(StageTimer&&) noexcept = delete;
+
+	private:
+		double& m_Milliseconds;
+		PerfCounterValues& m_Counters;
+		PerfCounters const* const m_pPerfCounters;
+		PerfCounterValues const m_StartCounters;
+		std::chrono::steady_clock::time_point const m_Start;
+	};
+
+	//Fills with non-temporal stores, they bypass the cache for memory that isn't read again soon
+	void StreamFill(uint32_t* pDst, int count, uint32_t value)
+	{
+#ifdef RENDERER_STREAMING_STORES
+		for (; count > 0 && (reinterpret_cast<uintptr_t>(pDst) & 15) != 0; --count)
+			*pDst++ = value;
+
+		__m128i const value4{ _mm_set1_epi32(static_cast<int>(value)) };
+		for (; count >= 4; count -= 4, pDst += 4)
+			_mm_stream_si128(reinterpret_cast<__m128i*>(pDst), value4);
+#endif
+		std::fill_n(pDst, count, value);
+	}
+
+	//Orders the streaming stores before the buffer is handed to another thread
+	void StreamFence()
+	{
+#ifdef RENDERER_STREAMING_STORES
+		_mm_sfence();
+#endif
+	}
+}
+
+Renderer::Renderer(SDL_Window* pWindow, std::shared_ptr<MeshData const> pMesh) :
+	Renderer(std::make_unique<WindowRenderTarget>(pWindow), std::move(pMesh))
+{
+}
+
+Renderer::Renderer(int width, int height, std::shared_ptr<MeshData const> pMesh) :
+	Renderer(std::make_unique<OffscreenRenderTarget>(width, height), std::move(pMesh))
+{
+}
+
+Renderer::Renderer(std::unique_ptr<RenderTarget> pRenderTarget, std::shared_ptr<MeshData const> pMesh) :
+	m_pRenderTarget(std::move(pRenderTarget))
 {
 	//Initialize
-	SDL_GetWindowSize(pWindow, &m_Width, &m_Height);
+	m_Width = m_pRenderTarget->GetWidth();
+	m_Height = m_pRenderTarget->GetHeight();
+
+	//Create Buffers, the back buffer is picked up every frame since it changes when frames are pipelined
+	m_pBackBufferPixels = m_pRenderTarget->GetBackBuffer();
+	m_PixelPacker = PixelPacker{ m_pRenderTarget->GetFormat() };
+	m_ClearColor = m_PixelPacker.Pack(100, 100, 100);
 
-	//Create Buffers
-	m_pFrontBuffer = SDL_GetWindowSurface(pWindow);
-	m_pBackBuffer = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
-	m_pBackBufferPixels = (uint32_t*)m_pBackBuffer->pixels;
+	m_IsBandCleared.resize((m_Height + m_ClearBandHeight - 1) / m_ClearBandHeight);
 
-	m_pDepthBufferPixels = new float[m_Width * m_Height];
-	std::fill_n(m_pDepthBufferPixels, (m_Width * m_Height), FLT_MAX);
+	m_DepthBuffer = DepthBuffer{ m_Width, m_Height };
 
 	//Initialize Camera
 	m_Camera.Initialize(45.f, { .0f,5.f,-64.f }, static_cast<float>(m_Width / m_Height));
 
-	//Initialize the vehicle mesh
-	Mesh m{};
+	//Initialize the vehicle mesh, renderers drawing the same scene can share it
+	size_t const vehicleIdx{ AddMesh(pMesh ? std::move(pMesh) : LoadMesh("vehicle")) };
+	m_Meshes[vehicleIdx].Translate({ 0.f, 0.f, 0.f });
+}
+
+Renderer::~Renderer() = default;
+
+bool Renderer::EnablePerfCounters()
+{
+	m_pPerfCounters = std::make_unique<PerfCounters>();
+	if (!m_pPerfCounters->IsAvailable())
+		m_pPerfCounters.reset();
+
+	return m_pPerfCounters != nullptr;
+}
+
+void Renderer::SetSampleCount(uint32_t sampleCount)
+{
+	assert(Multisample::IsSupported(sampleCount));
+
+	m_SampleCount = sampleCount;
+	m_DepthBuffer = DepthBuffer{ m_Width, m_Height, m_DepthBuffer.GetFormat(), m_SampleCount };
+
+	m_SampleColors.clear();
+	if (m_SampleCount > 1)
+		m_SampleColors.resize(static_cast<size_t>(m_Width) * m_Height * m_SampleCount);
+	m_SampleColors.shrink_to_fit();
+
+	m_IsFrameDirty = true;
+}
+
+FramebufferMemory Renderer::GetFramebufferMemory() const noexcept
+{
+	return { static_cast<size_t>(m_Width) * m_Height * sizeof(uint32_t) * m_pRenderTarget->GetBufferCount(), m_DepthBuffer.GetMemoryBytes(), m_SampleColors.size() * sizeof(uint32_t) };
+}
+
+FramebufferMemory Renderer::GetFramebufferMemory(int width, int height, DepthFormat format, uint32_t sampleCount, uint32_t bufferCount) noexcept
+{
+	size_t const pixelCount{ static_cast<size_t>(width) * height };
+	return { pixelCount * sizeof(uint32_t) * bufferCount, pixelCount * sampleCount * DepthBuffer::GetBytesPerPixel(format),
+		sampleCount > 1 ? pixelCount * sampleCount * sizeof(uint32_t) : 0 };
+}
+
+std::shared_ptr<MeshData const> Renderer::LoadMesh(std::string const& name)
+{
+	auto const pMesh{ std::make_shared<MeshData>() };
+	MeshData& m{ *pMesh };
 	//parse the OBJ to load all required data
-	Utils::ParseOBJ("resources/vehicle.obj", m.vertices, m.indices);
+	Utils::ParseOBJ("resources/" + name + ".obj", m.vertices, m.indices);
 
-	//set vehicle textures - should be done through texture manager in bigger project to avoid copies and just maintain a reference the mesh
-	m.pDiffuse = std::make_shared<Texture>("resources/vehicle_diffuse.png");
-	m.pNormal = std::make_shared<Texture>("resources/vehicle_normal.png");
-	m.pSpecular = std::make_shared<Texture>("resources/vehicle_specular.png");
-	m.pGloss = std::make_shared<Texture>("resources/vehicle_gloss.png");
+	//should be done through texture manager in bigger project to avoid copies and just maintain a reference the mesh
+	//maps that are missing are replaced by a neutral color, a mesh with a single texture uses it as diffuse map
+	auto const loadTexture{ [&name](std::string const& suffix, ColorRGB const& fallback)
+	{
+		std::filesystem::path const path{ "resources/" + name + suffix + ".png" };
+		return std::filesystem::exists(path) ? std::make_shared<Texture>(path) : std::make_shared<Texture>(fallback);
+	} };
+	m.pDiffuse = loadTexture(std::filesystem::exists("resources/" + name + "_diffuse.png") ? "_diffuse" : "", colors::White);
+	//tangent space (0, 0, 1), the interpolated normal
+	m.pNormal = loadTexture("_normal", { .5f, .5f, 1.f });
+	m.pSpecular = loadTexture("_specular", colors::Black);
+	m.pGloss = loadTexture("_gloss", colors::Black);
 
 	m.primitiveTopology = PrimitiveTopology::TriangleList;
 
-	m.Translate({ 0.f, 0.f, 0.f });
-	m_Meshes.push_back(m);
+	//Reorder for the post-transform cache, then store the vertices in the order they are fetched
+	float const acmrBefore{ MeshOptimizer::CalculateACMR(m.indices, m.vertices.size()) };
+	MeshOptimizer::OptimizeVertexCache(m.indices, m.vertices.size());
+	MeshOptimizer::OptimizeVertexFetch(m.vertices, m.indices);
+
+	//Meshlets are grown from the cache optimized order and keep most of its locality
+	m.CalculateBounds();
+	MeshOptimizer::BuildMeshlets(m);
+	MeshOptimizer::BuildLODs(m);
+
+	float const acmrAfter{ MeshOptimizer::CalculateACMR(m.indices, m.vertices.size()) };
+	std::cout << name << ".obj - ACMR: " << acmrBefore << " -> " << acmrAfter << std::endl;
+	std::cout << name << ".obj - LOD triangles: " << m.indices.size() / 3;
+	for (auto const& lod : m.lods)
+		std::cout << " -> " << lod.indices.size() / 3;
+	std::cout << std::endl;
+
+	return pMesh;
 }
 
-Renderer::~Renderer()
+std::shared_ptr<MeshData> Renderer::CreateGrid(float width, float height, uint32_t cellCount)
 {
-	delete[] m_pDepthBufferPixels;
+	auto const pMesh{ std::make_shared<MeshData>() };
+	MeshData& m{ *pMesh };
+	m.primitiveTopology = PrimitiveTopology::TriangleList;
+
+	//row by row from the top left corner
+	for (uint32_t row{ 0 }; row <= cellCount; ++row)
+	{
+		for (uint32_t column{ 0 }; column <= cellCount; ++column)
+		{
+			Vector2 const uv{ static_cast<float>(column) / cellCount, static_cast<float>(row) / cellCount };
+			Vertex v{ Vector3{ (uv.x - .5f) * width, (.5f - uv.y) * height, 0.f } };
+			v.uv = uv;
+			v.normal = -Vector3::UnitZ;
+			v.tangent = Vector3::UnitX;
+			m.vertices.emplace_back(v);
+		}
+	}
+
+	//clockwise seen from -z, the winding the rasterizer draws
+	for (uint32_t row{ 0 }; row < cellCount; ++row)
+	{
+		for (uint32_t column{ 0 }; column < cellCount; ++column)
+		{
+			uint32_t const topLeft{ row * (cellCount + 1) + column };
+			uint32_t const bottomLeft{ topLeft + cellCount + 1 };
+			m.indices.insert(m.indices.end(), { topLeft, topLeft + 1, bottomLeft });
+			m.indices.insert(m.indices.end(), { topLeft + 1, bottomLeft + 1, bottomLeft });
+		}
+	}
+
+	m.CalculateBounds();
+	return pMesh;
 }
 
 void Renderer::Update(Timer* pTimer)
 {
-	m_Camera.Update(pTimer);
+	//A benchmark keeps the camera where it starts, the meshes rotate by a fixed angle per frame
+	if (!pTimer->IsBenchmarking())
+		m_Camera.Update(pTimer);
 	if (m_IsRotating)
 	{
 		for (auto& m : m_Meshes)
@@ -66,112 +249,640 @@ void Renderer::Update(Timer* pTimer)
 	}
 }
 
-void Renderer::Render()
+size_t Renderer::AddMesh(std::shared_ptr<MeshData const> pData, Matrix const& worldMatrix)
+{
+	MeshInstance mesh{ std::move(pData), worldMatrix };
+	m_Meshes.emplace_back(std::move(mesh));
+	m_TransformCache.emplace_back();
+	return m_Meshes.size() - 1;
+}
+
+void Renderer::SetInstances(size_t meshIdx, std::vector<Instance> instances)
+{
+	m_Meshes[meshIdx].instances = std::move(instances);
+	m_Meshes[meshIdx].isDirty = true;
+}
+
+void Renderer::SetWorldMatrix(size_t meshIdx, Matrix const& worldMatrix)
+{
+	m_Meshes[meshIdx].worldMatrix = worldMatrix;
+	m_Meshes[meshIdx].isDirty = true;
+}
+
+bool Renderer::Render()
 {
+	PROFILE_SCOPE("Frame");
+
+	//Nothing changed since the last frame, show it again without rasterizing
+	bool const isViewDirty{ m_Camera.isDirty };
+	bool isSceneDirty{ m_IsFrameDirty || isViewDirty };
+	for (MeshInstance const& mesh : m_Meshes)
+		isSceneDirty = isSceneDirty || mesh.isDirty;
+
+	if (!isSceneDirty)
+	{
+		m_pRenderTarget->Refresh();
+		return false;
+	}
+
 	//@START
-	//Lock BackBuffer
-	SDL_LockSurface(m_pBackBuffer);
+	m_pBackBufferPixels = m_pRenderTarget->GetBackBuffer();
+
+	m_Stats = {};
+	uint64_t const firstDepthWrites{ m_DepthBuffer.GetStats().firstWrites };
+	PerfCounterValues const frameStartCounters{ m_pPerfCounters ? m_pPerfCounters->Read() : PerfCounterValues{} };
+	auto const frameStart{ std::chrono::steady_clock::now() };
+
+	//clear the background and depth lazily, per band of rows
+	std::fill(m_IsBandCleared.begin(), m_IsBandCleared.end(), uint8_t{ 0 });
+
+	Frustum const frustum{ Frustum::FromMatrix(m_Camera.viewMatrix * m_Camera.projectionMatrix) };
+	bool isHiZValid{ false };
+	uint32_t meshesSinceHiZ{ 0 };
+
+	//Visibility and level of detail of all meshes first, so the triangle budget can be spread over what is visible
+	//Every instance is culled and gets a level of detail on its own
+	{
+		PROFILE_SCOPE("Cull");
+		StageTimer const stageTimer{ m_Stats.cullMs, m_Stats.cullCounters, m_pPerfCounters.get() };
+
+		m_DrawList.clear();
+		for (uint32_t meshIdx{ 0 }; meshIdx < m_Meshes.size(); ++meshIdx)
+		{
+			MeshInstance const& mesh{ m_Meshes[meshIdx] };
+			MeshData const& m{ *mesh.pData };
 
-	std::fill_n(m_pDepthBufferPixels, m_Width * m_Height, FLT_MAX);
-	std::fill_n(m_pBackBufferPixels, m_Width * m_Height, 0);
+			auto const queueDrawCall{ [&](Matrix const& worldMatrix, ColorRGB const& color)
+			{
+				//Frustum culling - sphere first since it's cheapest, the box is tighter for elongated meshes
+				if (!frustum.IsVisible(m.boundingSphere, worldMatrix) || !frustum.IsVisible(m.boundingBox, worldMatrix))
+				{
+					m_Stats.trianglesFrustumCulled += m.GetTriangleCount();
+					return;
+				}
+
+				DrawCall drawCall{ meshIdx };
+				drawCall.isInstanced = !mesh.instances.empty();
+				drawCall.worldMatrix = worldMatrix;
+				drawCall.color = color;
+				drawCall.lod = SelectLOD(m, worldMatrix, drawCall.screenRadius);
+				m_DrawList.emplace_back(drawCall);
+			} };
+
+			if (mesh.instances.empty())
+			{
+				queueDrawCall(mesh.worldMatrix, colors::White);
+				continue;
+			}
 
-	//clear the background
-	SDL_FillRect(m_pBackBuffer, NULL, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
+			for (Instance const& instance : mesh.instances)
+				queueDrawCall(mesh.worldMatrix * instance.worldMatrix, instance.color);
+		}
+		ApplyTriangleBudget();
+	}
 
 	//Meshes defined in world space
 	//World -> NDC
-	for (auto& m : m_Meshes)
+	for (DrawCall const& drawCall : m_DrawList)
 	{
-		VertexTransformationFunction(m);
+		MeshInstance const& mesh{ m_Meshes[drawCall.meshIdx] };
+		MeshData const& m{ *mesh.pData };
+		m_InstanceColor = drawCall.color;
+
+		//A mesh drawn once keeps its transformed vertices until it or the camera changes, instances share one buffer
+		if (drawCall.isInstanced)
+		{
+			m_pTransformed = &m_InstancedVertices;
+			m_pTransformed->stamp = ++m_TransformStamp;
+		}
+		else
+		{
+			m_pTransformed = &m_TransformCache[drawCall.meshIdx];
+			if (isViewDirty || mesh.isDirty || m_pTransformed->stamp == 0)
+				m_pTransformed->stamp = ++m_TransformStamp;
+		}
+
+		//Simplified levels are small on screen, they are drawn without meshlet culling
+		if (drawCall.lod > 0)
+		{
+			MeshLOD const& lod{ m.lods[drawCall.lod - 1] };
+			VertexTransformationFunction(m, drawCall.worldMatrix, lod);
+
+			{
+				PROFILE_SCOPE("Rasterize");
+				StageTimer const stageTimer{ m_Stats.rasterizeMs, m_Stats.rasterizeCounters, m_pPerfCounters.get() };
+				for (uint32_t v{ 0 }; v < lod.indices.size(); v += 3)
+					RenderTriangle(m, lod.indices, m_pTransformed->screenSpace, v, false);
+			}
 
-		//convert each NDC coordinates to screen space / raster space
-		std::vector<Vector2> vertices_screenSpace{};
-		for (auto const& vertex : m.vertices_out)
+			++meshesSinceHiZ;
+			continue;
+		}
+
+		if (!m.meshlets.empty())
 		{
-			float const x_screen{ (vertex.position.x + 1) * 0.5f * m_Width };
-			float const y_screen{ (1 - vertex.position.y) * 0.5f * m_Height };
+			//Only meshes drawn earlier this frame can occlude. Depth only decreases during a frame,
+			//so an older HiZ is still conservative and doesn't have to be rebuilt after every mesh
+			if (meshesSinceHiZ > 0 && (!isHiZValid || meshesSinceHiZ >= m_HiZRebuildInterval))
+			{
+				BuildHiZ();
+				isHiZValid = true;
+				meshesSinceHiZ = 0;
+			}
+
+			CullMeshlets(m, drawCall.worldMatrix, frustum, isHiZValid);
+			if (m_VisibleMeshlets.empty())
+				continue;
+
+			VertexTransformationFunction(m, drawCall.worldMatrix, m_VisibleMeshlets);
+
+			{
+				PROFILE_SCOPE("Rasterize");
+				StageTimer const stageTimer{ m_Stats.rasterizeMs, m_Stats.rasterizeCounters, m_pPerfCounters.get() };
+				for (uint32_t const meshletIdx : m_VisibleMeshlets)
+				{
+					Meshlet const& meshlet{ m.meshlets[meshletIdx] };
+					for (uint32_t t{ 0 }; t < meshlet.triangleCount; ++t)
+						RenderTriangle(m, m.indices, m_pTransformed->screenSpace, meshlet.indexOffset + t * 3, false);
+				}
+			}
 
-			vertices_screenSpace.emplace_back(Vector2{ x_screen, y_screen });
+			++meshesSinceHiZ;
+			continue;
 		}
 
+		VertexTransformationFunction(m, drawCall.worldMatrix);
+
+		PROFILE_SCOPE("Rasterize");
+		StageTimer const stageTimer{ m_Stats.rasterizeMs, m_Stats.rasterizeCounters, m_pPerfCounters.get() };
 		switch (m.primitiveTopology)
 		{
 		case PrimitiveTopology::TriangleList:
 			for (uint32_t v{ 0 }; v < m.indices.size(); v += 3)
-				RenderTriangle(m, vertices_screenSpace, v, false);
+				RenderTriangle(m, m.indices, m_pTransformed->screenSpace, v, false);
 			break;
 		case PrimitiveTopology::TriangleStrip:
 			for (uint32_t v{ 0 }; v < m.indices.size() - 2; ++v)
-				RenderTriangle(m, vertices_screenSpace, v, v % 2);
+				RenderTriangle(m, m.indices, m_pTransformed->screenSpace, v, v % 2);
 			break;
 		}
+
+		++meshesSinceHiZ;
 	}
 
 	//@END
-	//Update SDL Surface
-	SDL_UnlockSurface(m_pBackBuffer);
-	SDL_BlitSurface(m_pBackBuffer, 0, m_pFrontBuffer, 0);
-	SDL_UpdateWindowSurface(m_pWindow);
+	ResolveBands();
+	ClearUntouchedBands();
+	m_Stats.pixelsCovered = (m_DepthBuffer.GetStats().firstWrites - firstDepthWrites) / m_SampleCount;
+	{
+		PROFILE_SCOPE("Present");
+		StageTimer const stageTimer{ m_Stats.presentMs, m_Stats.presentCounters, m_pPerfCounters.get() };
+		m_pRenderTarget->Present();
+	}
+
+	m_Stats.frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+	if (m_pPerfCounters)
+		m_Stats.frameCounters = m_pPerfCounters->Read() - frameStartCounters;
+
+	//Everything is up to date with the current frame
+	m_Camera.isDirty = false;
+	m_IsFrameDirty = false;
+	for (MeshInstance& mesh : m_Meshes)
+		mesh.isDirty = false;
+
+	return true;
 }
 
-void Renderer::VertexTransformationFunction(Mesh& mesh) const
+void Renderer::VertexTransformationFunction(MeshData const& mesh, Matrix const& worldMatrix)
 {
+	PROFILE_SCOPE("Transform");
+	StageTimer const stageTimer{ m_Stats.transformMs, m_Stats.transformCounters, m_pPerfCounters.get() };
+
 	//projection stage:
 	//model -> world space -> world -> view space 
-	auto const m{ mesh.worldMatrix * m_Camera.viewMatrix * m_Camera.projectionMatrix };
-	mesh.vertices_out.clear();
-	mesh.vertices_out.reserve(mesh.vertices.size());
-	for(auto const& v : mesh.vertices)
-	{
-		Vertex_Out vOut{};
-		vOut.color = v.color;
-		vOut.uv = v.uv;
-
-		vOut.position = m.TransformPoint(v.position.ToPoint4() );
-
-		vOut.normal = mesh.worldMatrix.TransformVector(v.normal);
-		vOut.tangent = mesh.worldMatrix.TransformVector(v.tangent);
-		vOut.viewDirection = vOut.position - m_Camera.origin.ToPoint4();
-
-		//view -> clipping space (NDC)
-		float const inverseWComponent{ 1.f / vOut.position.w };
-		vOut.position.x *= inverseWComponent;
-		vOut.position.y *= inverseWComponent;
-		vOut.position.z *= inverseWComponent;
-		
-		mesh.vertices_out.emplace_back(vOut);
+	auto const m{ worldMatrix * m_Camera.viewMatrix * m_Camera.projectionMatrix };
+	ResizeTransformedVertices(mesh.vertices.size());
+	TransformVertices(mesh, m, worldMatrix, mesh.vertices.size(), [](size_t i) { return static_cast<uint32_t>(i); });
+}
+
+void Renderer::VertexTransformationFunction(MeshData const& mesh, Matrix const& worldMatrix, MeshLOD const& lod)
+{
+	PROFILE_SCOPE("Transform");
+	StageTimer const stageTimer{ m_Stats.transformMs, m_Stats.transformCounters, m_pPerfCounters.get() };
+
+	auto const m{ worldMatrix * m_Camera.viewMatrix * m_Camera.projectionMatrix };
+	ResizeTransformedVertices(mesh.vertices.size());
+
+	TransformVertices(mesh, m, worldMatrix, lod.vertices.size(), [&lod](size_t i) { return lod.vertices[i]; });
+}
+
+uint32_t Renderer::SelectLOD(MeshData const& mesh, Matrix const& worldMatrix, float& screenRadius) const
+{
+	float const maxScale{ std::max({ worldMatrix.GetAxisX().Magnitude(), worldMatrix.GetAxisY().Magnitude(), worldMatrix.GetAxisZ().Magnitude() }) };
+	float const radius{ mesh.boundingSphere.radius * maxScale };
+	Vector3 const center{ worldMatrix.TransformPoint(mesh.boundingSphere.center) };
+
+	//Camera inside the bounding sphere, always full detail
+	float const distance{ (center - m_Camera.origin).Magnitude() - radius };
+	if (distance <= m_Camera.nearPlane)
+	{
+		screenRadius = FLT_MAX;
+		return 0;
+	}
+
+	//Pixels per world unit at the point of the bounding sphere closest to the camera
+	float const pixelsPerUnit{ m_Height / (2.f * distance * m_Camera.fov) };
+	screenRadius = radius * pixelsPerUnit;
+
+	if (!m_UseLOD)
+		return 0;
+
+	//Coarsest level that moves the surface less than the allowed amount of pixels
+	uint32_t lod{ 0 };
+	while (lod < mesh.lods.size() && mesh.lods[lod].error * maxScale * pixelsPerUnit <= m_LODPixelError)
+		++lod;
+
+	return lod;
+}
+
+void Renderer::ApplyTriangleBudget()
+{
+	//Largest on screen first, the smallest meshes lose detail first when over budget
+	std::sort(m_DrawList.begin(), m_DrawList.end(), [](DrawCall const& lhs, DrawCall const& rhs) { return lhs.screenRadius > rhs.screenRadius; });
+
+	auto const triangleCount{ [this](DrawCall const& drawCall) -> size_t
+	{
+		return m_Meshes[drawCall.meshIdx].pData->GetTriangleCount(drawCall.lod);
+	} };
+
+	size_t totalTriangles{ 0 };
+	for (DrawCall const& drawCall : m_DrawList)
+		totalTriangles += triangleCount(drawCall);
+
+	if (!m_UseLOD)
+		return;
+
+	for (auto it{ m_DrawList.rbegin() }; it != m_DrawList.rend() && totalTriangles > m_TriangleBudget; ++it)
+	{
+		uint32_t const lodCount{ static_cast<uint32_t>(m_Meshes[it->meshIdx].pData->lods.size()) };
+		while (it->lod < lodCount && totalTriangles > m_TriangleBudget)
+		{
+			totalTriangles -= triangleCount(*it);
+			++it->lod;
+			totalTriangles += triangleCount(*it);
+		}
+	}
+}
+
+void Renderer::VertexTransformationFunction(MeshData const& mesh, Matrix const& worldMatrix, std::vector<uint32_t> const& meshletIndices)
+{
+	PROFILE_SCOPE("Transform");
+	StageTimer const stageTimer{ m_Stats.transformMs, m_Stats.transformCounters, m_pPerfCounters.get() };
+
+	//Only the vertices referenced by the given meshlets are transformed, the others keep stale data until their stamp is checked
+	auto const m{ worldMatrix * m_Camera.viewMatrix * m_Camera.projectionMatrix };
+	ResizeTransformedVertices(mesh.vertices.size());
+
+	for (uint32_t const meshletIdx : meshletIndices)
+	{
+		Meshlet const& meshlet{ mesh.meshlets[meshletIdx] };
+		uint32_t const* pVertices{ &mesh.meshletVertices[meshlet.vertexOffset] };
+		TransformVertices(mesh, m, worldMatrix, meshlet.vertexCount, [pVertices](size_t i) { return pVertices[i]; });
+	}
+}
+
+void Renderer::ResizeTransformedVertices(size_t vertexCount)
+{
+	//new vertices get stamp 0, which is never a valid stamp
+	m_pTransformed->vertices.resize(vertexCount);
+	m_pTransformed->screenSpace.resize(vertexCount);
+	m_pTransformed->stamps.resize(vertexCount, 0);
+}
+
+template<typename VertexIndexFn>
+void Renderer::TransformVertices(MeshData const& mesh, Matrix const& worldViewProjection, Matrix const& world, size_t vertexCount, VertexIndexFn const& vertexIndex)
+{
+	TransformedVertices& out{ *m_pTransformed };
+
+	//Positions go through the structure of arrays transforms a block at a time, the attributes only need one vertex at a time
+	//a block stays in cache until its attributes are set up
+	uint32_t constexpr blockSize{ 64 };
+	struct alignas(16) Block
+	{
+		std::array<uint32_t, blockSize> indices;
+		std::array<float, blockSize> x, y, z;
+		std::array<float, blockSize> clipX, clipY, clipZ, clipW;
+	};
+	Block block;
+
+	for (size_t start{ 0 }; start < vertexCount; start += blockSize)
+	{
+		size_t const end{ std::min<size_t>(start + blockSize, vertexCount) };
+
+		//vertices shared with an earlier block or meshlet are already up to date
+		size_t count{ 0 };
+		for (size_t i{ start }; i < end; ++i)
+		{
+			uint32_t const vertexIdx{ vertexIndex(i) };
+			if (out.stamps[vertexIdx] == out.stamp)
+				continue;
+
+			out.stamps[vertexIdx] = out.stamp;
+			Vector3 const& position{ mesh.vertices[vertexIdx].position };
+			block.indices[count] = vertexIdx;
+			block.x[count] = position.x;
+			block.y[count] = position.y;
+			block.z[count] = position.z;
+			++count;
+		}
+		m_Stats.verticesTransformed += count;
+
+		std::span<float const> const x{ block.x.data(), count }, y{ block.y.data(), count }, z{ block.z.data(), count };
+		worldViewProjection.TransformPoints(x, y, z, block.clipX, block.clipY, block.clipZ, block.clipW);
+
+		for (size_t i{ 0 }; i < count; ++i)
+		{
+			uint32_t const vertexIdx{ block.indices[i] };
+			Vector4 const clipPosition{ block.clipX[i], block.clipY[i], block.clipZ[i], block.clipW[i] };
+			out.vertices[vertexIdx] = TransformVertex(mesh.vertices[vertexIdx], clipPosition, world);
+			out.screenSpace[vertexIdx] = ToScreenSpace(out.vertices[vertexIdx].position);
+		}
+	}
+}
+
+Vertex_Out Renderer::TransformVertex(Vertex const& v, Vector4 const& clipPosition, Matrix const& world) const
+{
+	Vertex_Out vOut{};
+	vOut.color = v.color;
+	vOut.uv = v.uv;
+
+	vOut.position = clipPosition;
+
+	vOut.normal = world.TransformVector(v.normal);
+	vOut.tangent = world.TransformVector(v.tangent);
+	vOut.viewDirection = world.TransformPoint(v.position) - m_Camera.origin;
+
+	//view -> clipping space (NDC)
+	float const inverseWComponent{ 1.f / vOut.position.w };
+	vOut.position.x *= inverseWComponent;
+	vOut.position.y *= inverseWComponent;
+	vOut.position.z *= inverseWComponent;
+
+	return vOut;
+}
+
+Vector2 Renderer::ToScreenSpace(Vector4 const& ndc) const
+{
+	return { (ndc.x + 1) * 0.5f * m_Width, (1 - ndc.y) * 0.5f * m_Height };
+}
+
+void Renderer::CullMeshlets(MeshData const& mesh, Matrix const& worldMatrix, Frustum const& frustum, bool useHiZ)
+{
+	PROFILE_SCOPE("Cull Meshlets");
+	StageTimer const stageTimer{ m_Stats.cullMs, m_Stats.cullCounters, m_pPerfCounters.get() };
+
+	m_VisibleMeshlets.clear();
+
+	//Cone test happens in local space, so move the camera there instead of transforming every cone
+	Vector3 const localCameraPosition{ Matrix::Inverse(worldMatrix).TransformPoint(m_Camera.origin) };
+
+	for (uint32_t i{ 0 }; i < mesh.meshlets.size(); ++i)
+	{
+		Meshlet const& meshlet{ mesh.meshlets[i] };
+
+		//Back-face cone, the whole cluster faces away when the view vector lies inside the cone (conservative with the bounding sphere)
+		Vector3 const toCenter{ meshlet.bounds.center - localCameraPosition };
+		if (Vector3::Dot(toCenter, meshlet.coneAxis) >= meshlet.coneCutoff * toCenter.Magnitude() + meshlet.bounds.radius)
+		{
+			m_Stats.trianglesBackFacing += meshlet.triangleCount;
+			continue;
+		}
+
+		if (!frustum.IsVisible(meshlet.bounds, worldMatrix))
+		{
+			m_Stats.trianglesFrustumCulled += meshlet.triangleCount;
+			continue;
+		}
+
+		if (useHiZ && IsOccluded(meshlet.bounds, worldMatrix))
+		{
+			m_Stats.trianglesOccluded += meshlet.triangleCount;
+			continue;
+		}
+
+		m_VisibleMeshlets.emplace_back(i);
+	}
+}
+
+void Renderer::ClearBands(int minY, int maxY)
+{
+	if (minY >= maxY)
+		return;
+
+	for (int band{ minY / m_ClearBandHeight }; band <= (maxY - 1) / m_ClearBandHeight; ++band)
+	{
+		uint8_t& isCleared{ m_IsBandCleared[band] };
+		if (isCleared)
+			continue;
+		isCleared = 1;
+
+		//Regular stores, the triangle reads the depth and writes the color right after
+		//Multisampled bands clear their samples instead, the resolve writes every pixel of the band
+		int const startPixel{ band * m_ClearBandHeight * m_Width };
+		int const pixelCount{ (std::min((band + 1) * m_ClearBandHeight, m_Height) - band * m_ClearBandHeight) * m_Width };
+		if (m_SampleColors.empty())
+			std::fill_n(&m_pBackBufferPixels[startPixel], pixelCount, m_ClearColor);
+		else
+		{
+			size_t const sampleCount{ static_cast<size_t>(pixelCount) * m_SampleCount };
+			std::fill_n(&m_SampleColors[static_cast<size_t>(startPixel) * m_SampleCount], sampleCount, m_ClearColor);
+			m_Stats.sampleColorBytes += sampleCount * sizeof(uint32_t);
+		}
+		m_DepthBuffer.Clear(startPixel, pixelCount);
+	}
+}
+
+void Renderer::ClearUntouchedBands()
+{
+	PROFILE_SCOPE("Clear");
+	StageTimer const stageTimer{ m_Stats.clearMs, m_Stats.clearCounters, m_pPerfCounters.get() };
+
+	for (int band{ 0 }; band < static_cast<int>(m_IsBandCleared.size()); ++band)
+	{
+		if (m_IsBandCleared[band])
+			continue;
+
+		//Only the present reads these pixels, streaming stores keep them from evicting the rest of the frame from the cache
+		int const startPixel{ band * m_ClearBandHeight * m_Width };
+		int const pixelCount{ (std::min((band + 1) * m_ClearBandHeight, m_Height) - band * m_ClearBandHeight) * m_Width };
+		StreamFill(&m_pBackBufferPixels[startPixel], pixelCount, m_ClearColor);
+	}
+
+	StreamFence();
+}
+
+void Renderer::ResolveBands()
+{
+	if (m_SampleColors.empty())
+		return;
+
+	PROFILE_SCOPE("Resolve");
+	StageTimer const stageTimer{ m_Stats.resolveMs, m_Stats.resolveCounters, m_pPerfCounters.get() };
+
+	uint32_t const sampleShift{ static_cast<uint32_t>(std::countr_zero(m_SampleCount)) };
+	for (int band{ 0 }; band < static_cast<int>(m_IsBandCleared.size()); ++band)
+	{
+		if (!m_IsBandCleared[band])
+			continue;
+
+		int const startPixel{ band * m_ClearBandHeight * m_Width };
+		int const pixelCount{ (std::min((band + 1) * m_ClearBandHeight, m_Height) - band * m_ClearBandHeight) * m_Width };
+		uint32_t const* pSamples{ &m_SampleColors[static_cast<size_t>(startPixel) * m_SampleCount] };
+		for (int pixel{ startPixel }; pixel < startPixel + pixelCount; ++pixel, pSamples += m_SampleCount)
+		{
+			//Only pixels on an edge hold different colors, the rest are copied
+			bool isUniform{ true };
+			for (uint32_t s{ 1 }; s < m_SampleCount; ++s)
+				isUniform = isUniform && pSamples[s] == pSamples[0];
+
+			m_pBackBufferPixels[pixel] = isUniform ? pSamples[0] : Multisample::Resolve(pSamples, m_SampleCount, sampleShift);
+		}
+
+		m_Stats.sampleColorBytes += static_cast<uint64_t>(pixelCount) * m_SampleCount * sizeof(uint32_t);
+	}
+}
+
+void Renderer::BuildHiZ()
+{
+	PROFILE_SCOPE("Build HiZ");
+	StageTimer const stageTimer{ m_Stats.cullMs, m_Stats.cullCounters, m_pPerfCounters.get() };
+
+	m_HiZWidth = (m_Width + m_HiZTileSize - 1) / m_HiZTileSize;
+	m_HiZHeight = (m_Height + m_HiZTileSize - 1) / m_HiZTileSize;
+	m_HiZ.assign(static_cast<size_t>(m_HiZWidth) * m_HiZHeight, 0.f);
+	m_HiZDepthRow.resize(m_Width);
+
+	for (int py{ 0 }; py < m_Height; ++py)
+	{
+		float* pTileRow{ &m_HiZ[(py / m_HiZTileSize) * m_HiZWidth] };
+
+		//Nothing was drawn in the band yet, its depth buffer still holds an old frame
+		if (!m_IsBandCleared[py / m_ClearBandHeight])
+		{
+			std::fill_n(pTileRow, m_HiZWidth, FLT_MAX);
+			continue;
+		}
+
+		//HiZ is in the 0 near to 1 far range whatever the depth format
+		m_DepthBuffer.Decode(py * m_Width, m_Width, m_HiZDepthRow.data());
+		for (int px{ 0 }; px < m_Width; ++px)
+		{
+			float& tile{ pTileRow[px / m_HiZTileSize] };
+			tile = std::max(tile, m_HiZDepthRow[px]);
+		}
+	}
+}
+
+bool Renderer::IsOccluded(BoundingSphere const& localSphere, Matrix const& worldMatrix) const
+{
+	float const maxScale{ std::max({ worldMatrix.GetAxisX().Magnitude(), worldMatrix.GetAxisY().Magnitude(), worldMatrix.GetAxisZ().Magnitude() }) };
+	float const radius{ localSphere.radius * maxScale };
+	Vector3 const center{ m_Camera.viewMatrix.TransformPoint(worldMatrix.TransformPoint(localSphere.center)) };
+
+	//Sphere crosses the near plane, projecting it isn't reliable
+	if (center.z - radius <= m_Camera.nearPlane)
+		return false;
+
+	//Corners of the view space box around the sphere and the point of it nearest to the camera, projected together
+	std::array<Vector3, 9> points{};
+	for (int corner{ 0 }; corner < 8; ++corner)
+	{
+		points[corner] = { center.x + ((corner & 1) ? radius : -radius),
+						   center.y + ((corner & 2) ? radius : -radius),
+						   center.z + ((corner & 4) ? radius : -radius) };
+	}
+	points[8] = { center.x, center.y, center.z - radius };
+
+	std::array<Vector4, 9> clip{};
+	m_Camera.projectionMatrix.TransformPoints(points, clip);
+
+	//Screen rect of the box
+	Vector2 topLeft{ FLT_MAX, FLT_MAX };
+	Vector2 bottomRight{ -FLT_MAX, -FLT_MAX };
+	for (int corner{ 0 }; corner < 8; ++corner)
+	{
+		Vector2 const screen{ ToScreenSpace({ clip[corner].x / clip[corner].w, clip[corner].y / clip[corner].w, 0.f, 1.f }) };
+
+		topLeft = Vector2::Min(topLeft, screen);
+		bottomRight = Vector2::Max(bottomRight, screen);
+	}
+
+	float nearestDepth{ clip[8].z / clip[8].w };
+	if (m_Camera.isDepthReversed)
+		nearestDepth = 1.f - nearestDepth;
+
+	int const minTileX{ Clamp(static_cast<int>(topLeft.x) / m_HiZTileSize, 0, m_HiZWidth - 1) };
+	int const minTileY{ Clamp(static_cast<int>(topLeft.y) / m_HiZTileSize, 0, m_HiZHeight - 1) };
+	int const maxTileX{ Clamp(static_cast<int>(bottomRight.x) / m_HiZTileSize, 0, m_HiZWidth - 1) };
+	int const maxTileY{ Clamp(static_cast<int>(bottomRight.y) / m_HiZTileSize, 0, m_HiZHeight - 1) };
+
+	for (int ty{ minTileY }; ty <= maxTileY; ++ty)
+	{
+		for (int tx{ minTileX }; tx <= maxTileX; ++tx)
+		{
+			if (m_HiZ[tx + ty * m_HiZWidth] >= nearestDepth)
+				return false;
+		}
 	}
+
+	return true;
 }
 
-void dae::Renderer::RenderTriangle(Mesh const& m, std::vector<Vector2> const& vertices, uint32_t startVertex, bool swapVertex)
+void dae::Renderer::RenderTriangle(MeshData const& m, std::vector<uint32_t> const& indices, std::vector<Vector2> const& vertices, uint32_t startVertex, bool swapVertex)
 {
 	//Rasterization stage
-	const size_t idx1{ m.indices[startVertex + (2 * swapVertex)] };
-	const size_t idx2{ m.indices[startVertex + 1] };
-	const size_t idx3{ m.indices[startVertex + (!swapVertex * 2)] };
+	std::vector<Vertex_Out> const& verticesOut{ m_pTransformed->vertices };
+	const size_t idx1{ indices[startVertex + (2 * swapVertex)] };
+	const size_t idx2{ indices[startVertex + 1] };
+	const size_t idx3{ indices[startVertex + (!swapVertex * 2)] };
 
 	//Culling
 	if (idx1 == idx2 || idx2 == idx3 || idx3 == idx1)
 	{
+		++m_Stats.trianglesZeroArea;
 		return;
 	}
 
-	if (m.vertices_out[idx1].position.x < -1.f || m.vertices_out[idx1].position.x > 1.f || m.vertices_out[idx1].position.y < -1.f || m.vertices_out[idx1].position.y > 1.f)
+	if (verticesOut[idx1].position.x < -1.f || verticesOut[idx1].position.x > 1.f || verticesOut[idx1].position.y < -1.f || verticesOut[idx1].position.y > 1.f)
 	{
+		++m_Stats.trianglesClipped;
 		return;
 	}
-	if (m.vertices_out[idx2].position.x < -1.f || m.vertices_out[idx2].position.x > 1.f || m.vertices_out[idx2].position.y < -1.f || m.vertices_out[idx2].position.y > 1.f)
+	if (verticesOut[idx2].position.x < -1.f || verticesOut[idx2].position.x > 1.f || verticesOut[idx2].position.y < -1.f || verticesOut[idx2].position.y > 1.f)
 	{
+		++m_Stats.trianglesClipped;
 		return;
 	}
-	if (m.vertices_out[idx3].position.x < -1.f || m.vertices_out[idx3].position.x > 1.f || m.vertices_out[idx3].position.y < -1.f || m.vertices_out[idx3].position.y > 1.f)
+	if (verticesOut[idx3].position.x < -1.f || verticesOut[idx3].position.x > 1.f || verticesOut[idx3].position.y < -1.f || verticesOut[idx3].position.y > 1.f)
 	{
+		++m_Stats.trianglesClipped;
 		return;
 	}
 
 	const Vector2 vert0{ vertices[idx1] };
 	const Vector2 vert1{ vertices[idx2] };
 	const Vector2 vert2{ vertices[idx3] };
+
+	//Facing away or without area on screen, no pixel passes the edge tests (bounding boxes are still drawn)
+	float const totalTriangleArea{ Vector2::Cross(vert1 - vert0, vert2 - vert0) };
+	if (totalTriangleArea <= 0.f && !m_ShowBoundingBoxes)
+	{
+		++(totalTriangleArea < 0.f ? m_Stats.trianglesBackFacing : m_Stats.trianglesZeroArea);
+		return;
+	}
+	float const invTotalTriangleArea{ 1.f / totalTriangleArea };
+	++m_Stats.trianglesRasterized;
+
 	//Bounding boxes logic - only loop over pixels within the smallest possible bounding box
 	Vector2 topLeft{ Vector2::Min(vert0,Vector2::Min(vert1,vert2)) - Vector2{1.f, 1.f} };
 	Vector2 topRight{ Vector2::Max(vert0,Vector2::Max(vert1,vert2)) + Vector2{1.f, 1.f} };
@@ -182,100 +893,184 @@ void dae::Renderer::RenderTriangle(Mesh const& m, std::vector<Vector2> const& ve
 		topRight.x = Clamp(topRight.x, 0.f, static_cast<float>(m_Width));
 		topRight.y = Clamp(topRight.y, 0.f, static_cast<float>(m_Height));
 
+	if (topLeft.x < topRight.x)
+		ClearBands(static_cast<int>(topLeft.y), static_cast<int>(topRight.y));
+
+	//Constant sample counts, a single sample compiles to the plain per pixel loop
+	switch (m_SampleCount)
+	{
+	case 2:
+		RasterizePixels<2>(m, idx1, idx2, idx3, vert0, vert1, vert2, invTotalTriangleArea, topLeft, topRight);
+		break;
+	case 4:
+		RasterizePixels<4>(m, idx1, idx2, idx3, vert0, vert1, vert2, invTotalTriangleArea, topLeft, topRight);
+		break;
+	case 8:
+		RasterizePixels<8>(m, idx1, idx2, idx3, vert0, vert1, vert2, invTotalTriangleArea, topLeft, topRight);
+		break;
+	default:
+		RasterizePixels<1>(m, idx1, idx2, idx3, vert0, vert1, vert2, invTotalTriangleArea, topLeft, topRight);
+		break;
+	}
+}
+
+template<uint32_t SampleCount>
+void Renderer::RasterizePixels(MeshData const& m, size_t idx1, size_t idx2, size_t idx3, Vector2 const& vert0, Vector2 const& vert1, Vector2 const& vert2,
+	float invTotalTriangleArea, Vector2 const& topLeft, Vector2 const& topRight)
+{
+	std::vector<Vertex_Out> const& verticesOut{ m_pTransformed->vertices };
+
+	//Counted locally, the pixel loop doesn't have to write them through this
+	uint64_t pixelsTested{ 0 };
+	uint64_t pixelsPassed{ 0 };
+
+	//Coverage and depth per sample, a single sample is the pixel center
+	std::span<Vector2 const> const samplePositions{ Multisample::GetSamplePositions(SampleCount) };
+	uint32_t constexpr allSamples{ (1u << SampleCount) - 1 };
+	uint64_t samplesWritten{ 0 };
+
+	//Barycentric coordinates of a point, divided by the total triangle area
+	auto const getWeights{ [&](Vector2 const& point)
+	{
+		return Vector3{ Vector2::Cross((point - vert1), (vert1 - vert2)),
+						Vector2::Cross((point - vert2), (vert2 - vert0)),
+						Vector2::Cross((point - vert0), (vert0 - vert1)) };
+	} };
+
+	//Packed color to the covered samples, or the pixel itself without multisampling
+	auto const writeColor{ [&](int pixelIdx, uint32_t coverage, uint32_t color)
+	{
+		if constexpr (SampleCount == 1)
+		{
+			m_pBackBufferPixels[pixelIdx] = color;
+			return;
+		}
+
+		uint32_t* pSamples{ &m_SampleColors[static_cast<size_t>(pixelIdx) * SampleCount] };
+		for (uint32_t s{ 0 }; s < SampleCount; ++s)
+		{
+			if (coverage & (1u << s))
+				pSamples[s] = color;
+		}
+		samplesWritten += std::popcount(coverage);
+	} };
+
 	for (int px{ static_cast<int>(topLeft.x) }; px < static_cast<int>(topRight.x); ++px)
 	{
 		for (int py{ static_cast<int>(topLeft.y) }; py < static_cast<int>(topRight.y); ++py)
 		{
+			int const pixelIdx{ px + (py * m_Width) };
 			ColorRGB finalColor{ 1.f, 1.f, 1.f };
 
 			if (m_ShowBoundingBoxes)
 			{
-				m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-					static_cast<uint8_t>(finalColor.r * 255),
-					static_cast<uint8_t>(finalColor.g * 255),
-					static_cast<uint8_t>(finalColor.b * 255));
+				writeColor(pixelIdx, allSamples, m_PixelPacker.Pack(finalColor));
 
 				continue;
 			}
 
-			Vector2 const pixel{ px + .5f, py + .5f };
-
-			//Calculate barycentric coordinates
-			float weight0{ Vector2::Cross((pixel - vert1), (vert1 - vert2)) };
-			float weight1{ Vector2::Cross((pixel - vert2), (vert2 - vert0)) };
-			float weight2{ Vector2::Cross((pixel - vert0), (vert0 - vert1)) };
+			//Samples inside the triangle and in front of the stored depth
+			uint32_t coverage{ 0 };
+			bool isInside{ false };
+			Vector3 weights{};
+			float interpolatedDepth{};
+			for (uint32_t s{ 0 }; s < SampleCount; ++s)
+			{
+				Vector2 const sample{ px + samplePositions[s].x, py + samplePositions[s].y };
+				Vector3 sampleWeights{ getWeights(sample) };
+
+				// not in triangle
+				if (sampleWeights.x < 0.f || sampleWeights.y < 0.f || sampleWeights.z < 0.f)
+					continue;
+				isInside = true;
+
+				// divide by total triangle area && normalize
+				sampleWeights.x *= invTotalTriangleArea;
+				sampleWeights.y *= invTotalTriangleArea;
+				sampleWeights.z *= invTotalTriangleArea;
+
+				//NDC depth is linear in screen space, interpolating it needs no perspective correction
+				float const sampleDepth{ sampleWeights.x * verticesOut[idx1].position.z + sampleWeights.y * verticesOut[idx2].position.z + sampleWeights.z * verticesOut[idx3].position.z };
+				if (sampleDepth < 0.f || sampleDepth > 1.f || !m_DepthBuffer.TestAndWrite(pixelIdx * static_cast<int>(SampleCount) + static_cast<int>(s), sampleDepth))
+					continue;
+
+				//Attributes come from the first visible sample, inside the triangle unlike the pixel center of a partly covered pixel
+				if (!coverage)
+				{
+					weights = sampleWeights;
+					interpolatedDepth = sampleDepth;
+				}
+				coverage |= 1u << s;
+			}
 
-			// not in triangle
-			if (weight0 < 0.f || weight1 < 0.f || weight2 < 0.f)
+			if (isInside)
+				++pixelsTested;
+			if (!coverage)
 				continue;
+			++pixelsPassed;
 
-			// divide by total triangle area && normalize
-			float const totalTriangleArea{ Vector2::Cross(vert1 - vert0,vert2 - vert0) };
-			float const invTotalTriangleArea{ 1 / totalTriangleArea };
-			weight0 *= invTotalTriangleArea;
-			weight1 *= invTotalTriangleArea;
-			weight2 *= invTotalTriangleArea;
-
-			float const depth0{ m.vertices_out[idx1].position.z };
-			float const depth1{ m.vertices_out[idx2].position.z };
-			float const depth2{ m.vertices_out[idx3].position.z };
-			float const interpolatedDepth{ 1.f / (weight0 * (1.f / depth0) + weight1 * (1.f / depth1) + weight2 * (1.f / depth2)) };
-
-			if (interpolatedDepth < 0.f || interpolatedDepth > 1.f || m_pDepthBufferPixels[px + py * m_Width] < interpolatedDepth)
+			//Fully covered pixels are shaded at their center, like a single sample
+			if (SampleCount > 1 && coverage == allSamples)
 			{
-				continue;
+				weights = getWeights({ px + .5f, py + .5f }) * invTotalTriangleArea;
+				interpolatedDepth = weights.x * verticesOut[idx1].position.z + weights.y * verticesOut[idx2].position.z + weights.z * verticesOut[idx3].position.z;
 			}
-			m_pDepthBufferPixels[px + py * m_Width] = interpolatedDepth;
+			float const weight0{ weights.x };
+			float const weight1{ weights.y };
+			float const weight2{ weights.z };
+
+			//Attributes are interpolated perspective correct, through 1/w (view space depth)
+			float const invW0{ weight0 / verticesOut[idx1].position.w };
+			float const invW1{ weight1 / verticesOut[idx2].position.w };
+			float const invW2{ weight2 / verticesOut[idx3].position.w };
+			float const interpolatedW{ 1.f / (invW0 + invW1 + invW2) };
 
 			//Update Color in Buffer
 			Vertex_Out pixelToShade{};
-			pixelToShade.position = { float(px), float(py), interpolatedDepth,interpolatedDepth };
+			pixelToShade.position = { float(px), float(py), interpolatedDepth, interpolatedW };
 
-			const float r = weight0 * m.vertices_out[idx1].color.r + weight1 * m.vertices_out[idx2].color.r + weight2 * m.vertices_out[idx3].color.r;
-			const float g = weight0 * m.vertices_out[idx1].color.g + weight1 * m.vertices_out[idx2].color.g + weight2 * m.vertices_out[idx3].color.g;
-			const float b = weight0 * m.vertices_out[idx1].color.b + weight1 * m.vertices_out[idx2].color.b + weight2 * m.vertices_out[idx3].color.b;
+			const float r = weight0 * verticesOut[idx1].color.r + weight1 * verticesOut[idx2].color.r + weight2 * verticesOut[idx3].color.r;
+			const float g = weight0 * verticesOut[idx1].color.g + weight1 * verticesOut[idx2].color.g + weight2 * verticesOut[idx3].color.g;
+			const float b = weight0 * verticesOut[idx1].color.b + weight1 * verticesOut[idx2].color.b + weight2 * verticesOut[idx3].color.b;
 			
 			finalColor = { r, g, b };
 			pixelToShade.color = finalColor;
 
-			pixelToShade.uv = interpolatedDepth * ((weight0 * m.vertices[idx1].uv) / depth0
-												+ (weight1 * m.vertices[idx2].uv) / depth1
-												+ (weight2 * m.vertices[idx3].uv) / depth2);
-			pixelToShade.normal = Vector3{ interpolatedDepth * (weight0 * m.vertices_out[idx1].normal / m.vertices_out[idx1].position.w
-															  + weight1 * m.vertices_out[idx2].normal / m.vertices_out[idx2].position.w +
-																weight2 * m.vertices_out[idx3].normal / m.vertices_out[idx3].position.w) } / 3;
-			pixelToShade.tangent = Vector3{ interpolatedDepth * (weight0 * m.vertices_out[idx1].tangent / m.vertices_out[idx1].position.w +
-																 weight1 * m.vertices_out[idx2].tangent / m.vertices_out[idx2].position.w +
-																 weight2 * m.vertices_out[idx3].tangent / m.vertices_out[idx3].position.w) } / 3;
-			pixelToShade.viewDirection = Vector3{ interpolatedDepth * (weight0 * m.vertices_out[idx1].viewDirection / m.vertices_out[idx1].position.w +
-																	   weight1 * m.vertices_out[idx2].viewDirection / m.vertices_out[idx2].position.w +
-																	   weight2 * m.vertices_out[idx3].viewDirection / m.vertices_out[idx3].position.w) } / 3;
+			pixelToShade.uv = interpolatedW * (invW0 * m.vertices[idx1].uv + invW1 * m.vertices[idx2].uv + invW2 * m.vertices[idx3].uv);
+			pixelToShade.normal = interpolatedW * (invW0 * verticesOut[idx1].normal + invW1 * verticesOut[idx2].normal + invW2 * verticesOut[idx3].normal);
+			pixelToShade.tangent = interpolatedW * (invW0 * verticesOut[idx1].tangent + invW1 * verticesOut[idx2].tangent + invW2 * verticesOut[idx3].tangent);
+			pixelToShade.viewDirection = interpolatedW * (invW0 * verticesOut[idx1].viewDirection + invW1 * verticesOut[idx2].viewDirection + invW2 * verticesOut[idx3].viewDirection);
 			finalColor = PixelShading(m, pixelToShade);
 
 			//TODO
 			//float const remap{ DepthRemap(interpolatedDepth, 0.9975f, 1.0f) };
 			//finalColor *= ColorRGB(remap, remap, remap);
 
-			//Update Color in Buffer
-			finalColor.MaxToOne();
-			m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-				static_cast<uint8_t>(finalColor.r * 255),
-				static_cast<uint8_t>(finalColor.g * 255),
-				static_cast<uint8_t>(finalColor.b * 255));
+			//Update Color in Buffer, packing includes MaxToOne, once for every covered sample
+			writeColor(pixelIdx, coverage, m_PixelPacker.Pack(finalColor));
 		}
 	}
+
+	m_Stats.pixelsTested += pixelsTested;
+	m_Stats.pixelsPassed += pixelsPassed;
+	m_Stats.pixelsShaded += pixelsPassed;
+	m_Stats.sampleColorBytes += samplesWritten * sizeof(uint32_t);
 }
 
-ColorRGB dae::Renderer::PixelShading(Mesh const& m, Vertex_Out const& v)
+ColorRGB dae::Renderer::PixelShading(MeshData const& m, Vertex_Out const& v)
 {
 	//Global light
 	Vector3 const lightDirection{ .577f, -.577f, .577f };
 	ColorRGB constexpr ambientColor{ 0.03f, 0.03f, 0.03f };
 
 	ColorRGB result{ v.color };
+	ColorRGB ambient{ ambientColor };
 
 	float constexpr shininess{ 25.0f };
 	float constexpr KD{ 7.f };
+	float constexpr minRoughness{ .05f };
+
+	Vector3 const viewDirection{ v.viewDirection.Normalized() };
 
 	// Normal map
 	float observedArea{};
@@ -284,6 +1079,7 @@ ColorRGB dae::Renderer::PixelShading(Mesh const& m, Vertex_Out const& v)
 	Matrix const tangentSpaceAxis = { v.tangent, biNormal, v.normal, Vector3::Zero };
 
 	ColorRGB const normalColor = m.pNormal->Sample(v.uv);
+	++m_Stats.textureFetches;
 	Vector3 sampledNormal = { normalColor.r, normalColor.g, normalColor.b }; //range [0, 1]
 	sampledNormal = 2.f * sampledNormal - Vector3{ 1, 1, 1 }; //[0, 1] to [-1, 1]
 	sampledNormal = tangentSpaceAxis.TransformVector(sampledNormal).Normalized();
@@ -312,24 +1108,16 @@ ColorRGB dae::Renderer::PixelShading(Mesh const& m, Vertex_Out const& v)
 		case ShadingMode::Diffuse:
 		{
 			auto const lambert{ BRDF::Lambert(KD, m.pDiffuse->Sample(v.uv)) };
+			m_Stats.textureFetches += 1;
 			result = lambert * observedArea;
 			break;
 		}
 		case ShadingMode::Specular:
 		{
-			//TODO move pong to BRDF
 			ColorRGB const specularColor{ m.pSpecular->Sample(v.uv) };
 			float const phongExp{ m.pGloss->Sample(v.uv).r * shininess };
-
-			Vector3 const reflect{ Vector3::Reflect(-lightDirection, sampledNormal) };
-			float cosAngle{ Vector3::Dot(reflect, v.viewDirection) };
-			if (cosAngle < 0.f)
-			{
-				cosAngle = 0.f;
-			}
-
-			float const specReflection{ 1.f * powf(cosAngle, phongExp) };
-			ColorRGB const phong{ specReflection * specularColor };
+			ColorRGB const phong{ BRDF::Phong(specularColor, phongExp, -lightDirection, viewDirection, sampledNormal) };
+			m_Stats.textureFetches += 2;
 
 			result = phong * observedArea;
 			break;
@@ -339,25 +1127,37 @@ ColorRGB dae::Renderer::PixelShading(Mesh const& m, Vertex_Out const& v)
 			auto const lambert{ BRDF::Lambert(KD, m.pDiffuse->Sample(v.uv)) };
 			ColorRGB const specularColor{ m.pSpecular->Sample(v.uv) };
 			float const phongExp{ m.pGloss->Sample(v.uv).r * shininess };
-
-			Vector3 const reflect{ Vector3::Reflect(-lightDirection, sampledNormal) };
-			float cosAngle{ Vector3::Dot(reflect, v.viewDirection) };
-			if (cosAngle < 0.f)
-			{
-				cosAngle = 0.f;
-			}
-
-			 float const specReflection{ 1.f * powf(cosAngle, phongExp) };
-			 ColorRGB const phong{ specReflection * specularColor };
+			ColorRGB const phong{ BRDF::Phong(specularColor, phongExp, -lightDirection, viewDirection, sampledNormal) };
+			m_Stats.textureFetches += 3;
 
 			result =  observedArea * lambert + phong;
 			break;
 		}
+		case ShadingMode::PhysicallyBased:
+		{
+			//gloss map -> roughness, specular map -> F0 (dielectric workflow)
+			Vector3 const n{ m_UseNormalMapping ? sampledNormal : normal.Normalized() };
+			ColorRGB const albedo{ m.pDiffuse->Sample(v.uv) };
+			ColorRGB const f0{ m.pSpecular->Sample(v.uv) };
+			float const roughness{ std::max(1.f - m.pGloss->Sample(v.uv).r, minRoughness) };
+			m_Stats.textureFetches += 3;
+
+			ColorRGB fresnel{};
+			ColorRGB const cookTorrance{ BRDF::CookTorrance(n, -viewDirection, -lightDirection, f0, roughness, fresnel) };
+			ColorRGB const lambert{ BRDF::Lambert(ColorRGB{ 1.f, 1.f, 1.f } - fresnel, albedo) };
+
+			//split-sum approximation of the constant ambient light
+			ColorRGB const ambientSpecular{ m_DFGLookupTable.Evaluate(f0, Vector3::Dot(n, -viewDirection), roughness) };
+			ambient = ambientColor * (albedo + ambientSpecular);
+
+			result = (lambert + cookTorrance) * (KD * observedArea);
+			break;
+		}
 		}
 
 	}
-	result += ambientColor;
-	return result;
+	result += ambient;
+	return result * m_InstanceColor;
 }
 
 float dae::Renderer::DepthRemap(float v, float min, float max)
@@ -369,7 +1169,3 @@ float dae::Renderer::DepthRemap(float v, float min, float max)
 	return normalizedValue;
 }
 
-bool Renderer::SaveBufferToImage() const
-{
-	return SDL_SaveBMP(m_pBackBuffer, "Rasterizer_ColorBuffer.bmp");
-}
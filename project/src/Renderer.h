@@ -1,26 +1,66 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "Camera.h"
+#include "BRDF.h"
+#include "DepthBuffer.h"
+#include "Multisample.h"
+#include "PixelPacker.h"
+#include "RenderStats.h"
 
 struct SDL_Window;
-struct SDL_Surface;
 
 namespace dae
 {
 	class Texture;
-	struct Mesh;
+	class RenderTarget;
+	struct MeshData;
+	struct MeshInstance;
 	struct Vertex;
 	struct Vertex_Out;
+	struct MeshLOD;
+	struct Instance;
+	struct Frustum;
+	struct BoundingSphere;
 	class Timer;
 	class Scene;
 
+	//Bytes of the buffers a renderer draws into
+	struct FramebufferMemory
+	{
+		//every buffer of the ring
+		size_t backBuffer{};
+		//of every sample
+		size_t depth{};
+		//packed color of every sample, only allocated when multisampled
+		size_t sampleColors{};
+
+		size_t GetTotal() const noexcept { return backBuffer + depth + sampleColors; }
+	};
+
 	class Renderer final
 	{
 	public:
-		Renderer(SDL_Window* pWindow);
+		enum class ShadingMode : uint8_t
+		{
+			ObservedArea,
+			Diffuse,
+			Specular,
+			Combined,
+			PhysicallyBased,
+			Count
+		};
+
+		//A null mesh loads the vehicle, pass a mesh to share it between renderers
+		//Draws into the surface of the window, double buffered
+		Renderer(SDL_Window* pWindow, std::shared_ptr<MeshData const> pMesh = nullptr);
+		//Headless, draws into an offscreen framebuffer
+		Renderer(int width, int height, std::shared_ptr<MeshData const> pMesh = nullptr);
+		explicit Renderer(std::unique_ptr<RenderTarget> pRenderTarget, std::shared_ptr<MeshData const> pMesh = nullptr);
 		~Renderer();
 
 		Renderer(const Renderer&) = delete;
@@ -29,21 +69,75 @@ namespace dae
 		Renderer& operator=(Renderer&&) noexcept = delete;
 
 		void Update(Timer* pTimer);
-		void Render();
+		//Returns false when nothing changed and the previous frame was presented again
+		bool Render();
 
-		bool SaveBufferToImage() const;
+		//Frames are saved by an ImageWriter from the render target
+		RenderTarget const& GetRenderTarget() const noexcept
+		{
+			return *m_pRenderTarget;
+		}
 
-		void VertexTransformationFunction(Mesh& mesh) const;
+		Camera& GetCamera() noexcept
+		{
+			return m_Camera;
+		}
+
+		//Workload of the last rendered frame
+		RenderStats const& GetStats() const noexcept
+		{
+			return m_Stats;
+		}
+		//Counts the hardware events of every stage in the stats from the next frame on (Linux only)
+		//The counters follow the calling thread, which has to be the one rendering, false when they can't be opened
+		bool EnablePerfCounters();
+
+		//Format and test statistics of the depth buffer
+		DepthBuffer& GetDepthBuffer() noexcept
+		{
+			return m_DepthBuffer;
+		}
+
+		uint32_t GetSampleCount() const noexcept
+		{
+			return m_SampleCount;
+		}
+		//Every back buffer of the render target's ring, the depth buffer and the sample colors
+		FramebufferMemory GetFramebufferMemory() const noexcept;
+		//What a renderer drawing with these settings allocates, offscreen targets have a single buffer
+		static FramebufferMemory GetFramebufferMemory(int width, int height, DepthFormat format, uint32_t sampleCount, uint32_t bufferCount = 1) noexcept;
+
+		//Loads resources/<name>.obj with its <name>_diffuse/_normal/_specular/_gloss.png textures and optimizes it for drawing
+		[[nodiscard]] static std::shared_ptr<MeshData const> LoadMesh(std::string const& name);
+		//Flat grid of cellCount x cellCount squares of two triangles in the xy plane, centered on the origin and facing -z
+		//uv goes from 0 to 1 over the whole grid, the textures are left to the caller
+		[[nodiscard]] static std::shared_ptr<MeshData> CreateGrid(float width, float height, uint32_t cellCount);
+
+		//Output goes to the renderer's vertex buffers, cached per mesh or shared by all instances
+		void VertexTransformationFunction(MeshData const& mesh, Matrix const& worldMatrix);
+		//Transforms the vertices of the given meshlets and their screen space positions
+		void VertexTransformationFunction(MeshData const& mesh, Matrix const& worldMatrix, std::vector<uint32_t> const& meshletIndices);
+		//Transforms the vertices used by a level of detail and their screen space positions
+		void VertexTransformationFunction(MeshData const& mesh, Matrix const& worldMatrix, MeshLOD const& lod);
+
+		//Places shared geometry in the scene, returns the index of the new mesh
+		size_t AddMesh(std::shared_ptr<MeshData const> pData, Matrix const& worldMatrix = {});
+		//Draws the mesh once per instance instead of once with its own world matrix, an empty vector removes the instancing
+		void SetInstances(size_t meshIdx, std::vector<Instance> instances);
+		//Instances are placed after the world matrix of their mesh
+		void SetWorldMatrix(size_t meshIdx, Matrix const& worldMatrix);
 
 	#pragma region Settings
 		void ToggleBoundingBoxes() noexcept
 		{
 			m_ShowBoundingBoxes = !m_ShowBoundingBoxes;
+			m_IsFrameDirty = true;
 		}
 
 		void ToggleDepthBuffer() noexcept
 		{
 			m_ShowDepthBuffer = !m_ShowDepthBuffer;
+			m_IsFrameDirty = true;
 		}
 
 		void ToggleRotation() noexcept
@@ -54,6 +148,52 @@ namespace dae
 		void ToggleNormalMapping() noexcept
 		{
 			m_UseNormalMapping = !m_UseNormalMapping;
+			m_IsFrameDirty = true;
+		}
+
+		void ToggleLOD() noexcept
+		{
+			m_UseLOD = !m_UseLOD;
+			m_IsFrameDirty = true;
+		}
+
+		void SetTriangleBudget(uint32_t triangles) noexcept
+		{
+			m_TriangleBudget = triangles;
+			m_IsFrameDirty = true;
+		}
+
+		void SetShadingMode(ShadingMode mode) noexcept
+		{
+			m_CurrShadingMode = mode;
+			m_IsFrameDirty = true;
+		}
+
+		//Recreates the depth buffer, the projection follows the depth direction of the format
+		void SetDepthFormat(DepthFormat format)
+		{
+			m_DepthBuffer = DepthBuffer{ m_Width, m_Height, format, m_SampleCount };
+			m_Camera.isDepthReversed = m_DepthBuffer.IsReversed();
+			m_Camera.CalculateProjectionMatrix();
+			m_IsFrameDirty = true;
+		}
+
+		void CycleDepthFormat()
+		{
+			auto curr{ static_cast<uint8_t>(m_DepthBuffer.GetFormat()) };
+			++curr %= static_cast<uint8_t>(DepthFormat::Count);
+
+			SetDepthFormat(static_cast<DepthFormat>(curr));
+		}
+
+		//Multisample anti-aliasing with 2, 4 or 8 samples per pixel, 1 turns it off
+		//Coverage and depth are tested per sample while shading runs once per pixel per triangle,
+		//the samples are averaged into the back buffer at the end of the frame
+		void SetSampleCount(uint32_t sampleCount);
+
+		void CycleSampleCount()
+		{
+			SetSampleCount(m_SampleCount < Multisample::MaxSampleCount ? m_SampleCount * 2 : 1);
 		}
 
 		void CycleShadingMode() noexcept
@@ -62,17 +202,25 @@ namespace dae
 			++curr %= static_cast<uint8_t>(ShadingMode::Count);
 
 			m_CurrShadingMode = static_cast<ShadingMode>(curr);
+			m_IsFrameDirty = true;
 		}
 	#pragma endregion
 
 	private:
-		SDL_Window* m_pWindow{};
-
-		SDL_Surface* m_pFrontBuffer{ nullptr };
-		SDL_Surface* m_pBackBuffer{ nullptr };
+		std::unique_ptr<RenderTarget> m_pRenderTarget{};
 		uint32_t* m_pBackBufferPixels{};
+		//channel layout of the back buffer
+		PixelPacker m_PixelPacker{};
 
-		float* m_pDepthBufferPixels{};
+		DepthBuffer m_DepthBuffer{};
+		//Multisampling - the packed color of every sample, pixel * sample count + sample, empty with a single sample
+		//a single sample draws straight into the back buffer
+		uint32_t m_SampleCount{ 1 };
+		std::vector<uint32_t> m_SampleColors{};
+		//reset when a frame is rendered, frames presented again keep the counts of the frame they show
+		RenderStats m_Stats{};
+		//null unless hardware events are counted
+		std::unique_ptr<PerfCounters> m_pPerfCounters{};
 
 		Camera m_Camera{};
 
@@ -85,23 +233,93 @@ namespace dae
 		bool m_ShowDepthBuffer{ false };
 		bool m_IsRotating{ true };
 		bool m_UseNormalMapping{ true };
+		bool m_UseLOD{ true };
 
 
-		enum class ShadingMode : uint8_t
+		ShadingMode m_CurrShadingMode{ ShadingMode::ObservedArea };
+
+		std::vector<MeshInstance> m_Meshes;
+
+		BRDF::DFGLookupTable const m_DFGLookupTable{};
+
+		//Transformed vertices of a mesh, a vertex is up to date when its stamp equals the buffer's stamp
+		struct TransformedVertices
 		{
-			ObservedArea,
-			Diffuse,
-			Specular,
-			Combined,
-			Count
+			std::vector<Vertex_Out> vertices;
+			std::vector<Vector2> screenSpace;
+			std::vector<uint32_t> stamps;
+			uint32_t stamp{};
 		};
-		ShadingMode m_CurrShadingMode{ ShadingMode::ObservedArea };
+		//One per mesh, reused across frames while the mesh and camera don't change. Instanced meshes share m_InstancedVertices
+		std::vector<TransformedVertices> m_TransformCache;
+		TransformedVertices m_InstancedVertices;
+		TransformedVertices* m_pTransformed{ &m_InstancedVertices };
+		uint32_t m_TransformStamp{};
+
+		//Settings changed, the next frame has to be rendered even if the scene didn't change
+		bool m_IsFrameDirty{ true };
+		std::vector<uint32_t> m_VisibleMeshlets{};
+
+		//Level of detail selection - maximum projected simplification error and triangles drawn per frame
+		float m_LODPixelError{ 1.f };
+		uint32_t m_TriangleBudget{ 1'000'000 };
+
+		struct DrawCall
+		{
+			uint32_t meshIdx{};
+			uint32_t lod{};
+			float screenRadius{};
+			bool isInstanced{};
+			Matrix worldMatrix{};
+			ColorRGB color{ colors::White };
+		};
+		std::vector<DrawCall> m_DrawList{};
+		//Tint of the instance being drawn, applied after shading
+		ColorRGB m_InstanceColor{ colors::White };
+
+		//Hierarchical Z - farthest depth per tile, rebuilt lazily from the depth buffer between meshes
+		static constexpr int m_HiZTileSize{ 8 };
+		static constexpr uint32_t m_HiZRebuildInterval{ 16 };
+		std::vector<float> m_HiZ{};
+		//one row of the depth buffer, decoded
+		std::vector<float> m_HiZDepthRow{};
+		int m_HiZWidth{};
+		int m_HiZHeight{};
+
+		//Clear on first touch - a band of rows is cleared right before the first triangle covering it is drawn,
+		//bands no triangle covered are filled with the clear color before presenting and their depth is never cleared
+		//bands span the whole width so every clear is one contiguous fill, narrower tiles stride through memory
+		static constexpr int m_ClearBandHeight{ 16 };
+		static_assert(m_ClearBandHeight % m_HiZTileSize == 0, "HiZ tiles can't straddle clear bands");
+		std::vector<uint8_t> m_IsBandCleared{};
+		uint32_t m_ClearColor{};
+
+		void RenderTriangle(MeshData const& m, std::vector<uint32_t> const& indices, std::vector<Vector2> const& vertices, uint32_t startVertex, bool swapVertex);
+		//Pixel loop of RenderTriangle over the clamped bounding box, topRight is exclusive
+		template<uint32_t SampleCount>
+		void RasterizePixels(MeshData const& m, size_t idx1, size_t idx2, size_t idx3, Vector2 const& vert0, Vector2 const& vert1, Vector2 const& vert2,
+			float invTotalTriangleArea, Vector2 const& topLeft, Vector2 const& topRight);
+
+		void ResizeTransformedVertices(size_t vertexCount);
+		//Transforms the vertices vertexIndex(0) to vertexIndex(vertexCount - 1) that aren't up to date yet
+		template<typename VertexIndexFn>
+		void TransformVertices(MeshData const& mesh, Matrix const& worldViewProjection, Matrix const& world, size_t vertexCount, VertexIndexFn const& vertexIndex);
+		Vertex_Out TransformVertex(Vertex const& v, Vector4 const& clipPosition, Matrix const& world) const;
+		Vector2 ToScreenSpace(Vector4 const& ndc) const;
 
-		std::vector<Mesh> m_Meshes;
+		uint32_t SelectLOD(MeshData const& mesh, Matrix const& worldMatrix, float& screenRadius) const;
+		void ApplyTriangleBudget();
 
-		void RenderTriangle(Mesh const& m, std::vector<Vector2> const& vertices, uint32_t startVertex, bool swapVertex);
+		void CullMeshlets(MeshData const& mesh, Matrix const& worldMatrix, Frustum const& frustum, bool useHiZ);
+		//Rows, maxY is exclusive
+		void ClearBands(int minY, int maxY);
+		void ClearUntouchedBands();
+		//Averages the samples of the bands that were drawn to into the back buffer
+		void ResolveBands();
+		void BuildHiZ();
+		bool IsOccluded(BoundingSphere const& localSphere, Matrix const& worldMatrix) const;
 
-		ColorRGB PixelShading(Mesh const& m, Vertex_Out const& v);
+		ColorRGB PixelShading(MeshData const& m, Vertex_Out const& v);
 		float DepthRemap(float v, float min, float max);
 	};
 }
@@ -0,0 +1,137 @@
+#pragma once
+
+//Four floats in a register, the backend of Vector4 and Matrix
+//SSE on x86 (always there on x64), NEON on ARM, plain floats elsewhere or with DISABLE_MATH_SIMD
+//Only operations rounding like the scalar code are offered, no fused multiply-add, so every backend gives the same results
+#if defined(DISABLE_MATH_SIMD)
+#define MATH_SIMD_SCALAR
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define MATH_SIMD_SSE
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define MATH_SIMD_NEON
+#else
+#define MATH_SIMD_SCALAR
+#endif
+
+namespace dae::simd
+{
+#if defined(MATH_SIMD_SSE)
+	using Float4 = __m128;
+
+	//Unaligned, the math types keep the alignment of a float
+	inline Float4 Load(float const* pValues) noexcept { return _mm_loadu_ps(pValues); }
+	inline void Store(float* pValues, Float4 v) noexcept { _mm_storeu_ps(pValues, v); }
+	inline Float4 Set(float x, float y, float z, float w) noexcept { return _mm_setr_ps(x, y, z, w); }
+	inline Float4 Splat(float value) noexcept { return _mm_set1_ps(value); }
+
+	inline Float4 Add(Float4 a, Float4 b) noexcept { return _mm_add_ps(a, b); }
+	inline Float4 Sub(Float4 a, Float4 b) noexcept { return _mm_sub_ps(a, b); }
+	inline Float4 Mul(Float4 a, Float4 b) noexcept { return _mm_mul_ps(a, b); }
+
+	//Lanes of v in the given order, Shuffle<1, 2, 0, 3> is yzxw
+	template<int X, int Y, int Z, int W>
+	inline Float4 Shuffle(Float4 v) noexcept { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X)); }
+	template<int Lane>
+	inline float Get(Float4 v) noexcept { return _mm_cvtss_f32(Shuffle<Lane, Lane, Lane, Lane>(v)); }
+
+	//Rows become columns
+	inline void Transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3) noexcept { _MM_TRANSPOSE4_PS(r0, r1, r2, r3); }
+
+#elif defined(MATH_SIMD_NEON)
+	using Float4 = float32x4_t;
+
+	inline Float4 Load(float const* pValues) noexcept { return vld1q_f32(pValues); }
+	inline void Store(float* pValues, Float4 v) noexcept { vst1q_f32(pValues, v); }
+	inline Float4 Set(float x, float y, float z, float w) noexcept
+	{
+		float const values[4]{ x, y, z, w };
+		return vld1q_f32(values);
+	}
+	inline Float4 Splat(float value) noexcept { return vdupq_n_f32(value); }
+
+	//vmlaq_f32 may fuse the multiply and add, kept separate
+	inline Float4 Add(Float4 a, Float4 b) noexcept { return vaddq_f32(a, b); }
+	inline Float4 Sub(Float4 a, Float4 b) noexcept { return vsubq_f32(a, b); }
+	inline Float4 Mul(Float4 a, Float4 b) noexcept { return vmulq_f32(a, b); }
+
+	template<int X, int Y, int Z, int W>
+	inline Float4 Shuffle(Float4 v) noexcept
+	{
+		return Set(vgetq_lane_f32(v, X), vgetq_lane_f32(v, Y), vgetq_lane_f32(v, Z), vgetq_lane_f32(v, W));
+	}
+	template<int Lane>
+	inline float Get(Float4 v) noexcept { return vgetq_lane_f32(v, Lane); }
+
+	inline void Transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3) noexcept
+	{
+		//{ r0.x, r1.x, r0.z, r1.z } and { r0.y, r1.y, r0.w, r1.w }, the same for r2 and r3
+		float32x4x2_t const t01{ vtrnq_f32(r0, r1) };
+		float32x4x2_t const t23{ vtrnq_f32(r2, r3) };
+		r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+		r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+		r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+		r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+	}
+
+#else
+	struct Float4
+	{
+		float v[4];
+	};
+
+	inline Float4 Load(float const* pValues) noexcept { return { { pValues[0], pValues[1], pValues[2], pValues[3] } }; }
+	inline void Store(float* pValues, Float4 v) noexcept
+	{
+		for (int i{ 0 }; i < 4; ++i)
+			pValues[i] = v.v[i];
+	}
+	inline Float4 Set(float x, float y, float z, float w) noexcept { return { { x, y, z, w } }; }
+	inline Float4 Splat(float value) noexcept { return { { value, value, value, value } }; }
+
+	inline Float4 Add(Float4 a, Float4 b) noexcept { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+	inline Float4 Sub(Float4 a, Float4 b) noexcept { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+	inline Float4 Mul(Float4 a, Float4 b) noexcept { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+
+	template<int X, int Y, int Z, int W>
+	inline Float4 Shuffle(Float4 v) noexcept { return { { v.v[X], v.v[Y], v.v[Z], v.v[W] } }; }
+	template<int Lane>
+	inline float Get(Float4 v) noexcept { return v.v[Lane]; }
+
+	inline void Transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3) noexcept
+	{
+		Float4 const c0{ { r0.v[0], r1.v[0], r2.v[0], r3.v[0] } };
+		Float4 const c1{ { r0.v[1], r1.v[1], r2.v[1], r3.v[1] } };
+		Float4 const c2{ { r0.v[2], r1.v[2], r2.v[2], r3.v[2] } };
+		Float4 const c3{ { r0.v[3], r1.v[3], r2.v[3], r3.v[3] } };
+		r0 = c0;
+		r1 = c1;
+		r2 = c2;
+		r3 = c3;
+	}
+#endif
+
+	//Built on the operations above, shared by every backend
+
+	//a * b + c, rounded twice like the scalar expression
+	inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) noexcept { return Add(Mul(a, b), c); }
+
+	//In the order of x * x' + y * y' + z * z'
+	inline float Dot3(Float4 a, Float4 b) noexcept
+	{
+		Float4 const products{ Mul(a, b) };
+		return Get<0>(products) + Get<1>(products) + Get<2>(products);
+	}
+	inline float Dot4(Float4 a, Float4 b) noexcept
+	{
+		Float4 const products{ Mul(a, b) };
+		return Get<0>(products) + Get<1>(products) + Get<2>(products) + Get<3>(products);
+	}
+
+	//xyz of the cross product, w is 0 when both w are finite
+	inline Float4 Cross3(Float4 a, Float4 b) noexcept
+	{
+		return Sub(Mul(Shuffle<1, 2, 0, 3>(a), Shuffle<2, 0, 1, 3>(b)), Mul(Shuffle<2, 0, 1, 3>(a), Shuffle<1, 2, 0, 3>(b)));
+	}
+}
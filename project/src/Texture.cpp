@@ -1,6 +1,7 @@
 #include "Texture.h"
 #include "Vector2.h"
 #include <SDL_image.h>
+#include <algorithm>
 #include <cassert>
 
 namespace dae
@@ -16,6 +17,17 @@ namespace dae
 		m_pSurfacePixels = reinterpret_cast<uint32_t*>(m_pSurface->pixels);
 	}
 
+	Texture::Texture(ColorRGB const& color)
+	{
+		m_pSurface = SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 32, SDL_PIXELFORMAT_ARGB8888);
+		if (!m_pSurface)
+			throw std::runtime_error("Failed to create texture surface");
+
+		m_pSurfacePixels = reinterpret_cast<uint32_t*>(m_pSurface->pixels);
+		m_pSurfacePixels[0] = SDL_MapRGB(m_pSurface->format, static_cast<uint8_t>(color.r * 255.f + .5f),
+			static_cast<uint8_t>(color.g * 255.f + .5f), static_cast<uint8_t>(color.b * 255.f + .5f));
+	}
+
 	Texture::~Texture()
 	{
 		if (m_pSurface)
@@ -27,8 +39,9 @@ namespace dae
 
 	ColorRGB Texture::Sample(const Vector2& uv) const
 	{
-		uint32_t const x{ static_cast<uint32_t>(uv.x * m_pSurface->w) };
-		uint32_t const y{ static_cast<uint32_t>(uv.y * m_pSurface->h) };
+		//uv 1 lands on the texel past the edge
+		uint32_t const x{ std::min(static_cast<uint32_t>(uv.x * m_pSurface->w), static_cast<uint32_t>(m_pSurface->w - 1)) };
+		uint32_t const y{ std::min(static_cast<uint32_t>(uv.y * m_pSurface->h), static_cast<uint32_t>(m_pSurface->h - 1)) };
 
 		uint8_t r{};
 		uint8_t g{};
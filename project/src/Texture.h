@@ -12,6 +12,8 @@ namespace dae
 	{
 	public:
 		Texture(std::filesystem::path const& path);
+		//1x1 texture of a single color, stands in for maps a mesh doesn't have
+		explicit Texture(ColorRGB const& color);
 		~Texture();
 
 		ColorRGB Sample(const Vector2& uv) const;
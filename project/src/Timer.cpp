@@ -1,5 +1,9 @@
 #include "Timer.h"
 #include "SDL.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 using namespace dae;
 
 Timer::Timer()
@@ -18,6 +22,8 @@ void Timer::Reset()
 	m_FPSTimer = 0.0f;
 	m_FPSCount = 0;
 	m_IsStopped = false;
+
+	ResetFrameTimes();
 }
 
 void Timer::Start()
@@ -53,6 +59,37 @@ void Timer::Update()
 	if (m_ElapsedTime < 0.0f)
 		m_ElapsedTime = 0.0f;
 
+	//FRAME TIME LOGIC - the unclamped time of the frame, clamping would hide the spikes
+	float const frameTime = m_ElapsedTime * 1000.f;
+	if (frameTime > m_FrameBudget)
+		++m_OverBudgetCount;
+
+	//compared to the frames before it, a spike would raise the median it's measured against
+	if (m_FrameTimes.GetCount() >= MinSpikeFrames)
+	{
+		const float median = m_FrameTimes.GetPercentile(.5f);
+		if (frameTime > median * SpikeFactor)
+		{
+			if (m_Spikes.size() == MaxSpikes)
+				m_Spikes.pop_front();
+			m_Spikes.emplace_back(FrameSpike{ (float)(((m_CurrentTime - m_PausedTime) - m_BaseTime) * m_SecondsPerCount), frameTime, median });
+			++m_SpikeCount;
+		}
+	}
+	m_FrameTimes.Record(frameTime);
+
+	//BENCHMARK LOGIC - the unclamped time of the frame
+	if (m_IsBenchmarking)
+	{
+		if (m_BenchmarkWarmupLeft > 0)
+			--m_BenchmarkWarmupLeft;
+		else
+		{
+			m_BenchmarkFrameTimes.emplace_back(frameTime);
+			m_IsBenchmarking = m_BenchmarkFrameTimes.size() < m_BenchmarkFrames;
+		}
+	}
+
 	if (m_ForceElapsedUpperBound && m_ElapsedTime > m_ElapsedUpperBound)
 	{
 		m_ElapsedTime = m_ElapsedUpperBound;
@@ -72,6 +109,54 @@ void Timer::Update()
 	}
 }
 
+void Timer::StartBenchmark(uint32_t warmupFrames, uint32_t measuredFrames)
+{
+	m_IsBenchmarking = measuredFrames > 0;
+	m_BenchmarkWarmupFrames = warmupFrames;
+	m_BenchmarkWarmupLeft = warmupFrames;
+	m_BenchmarkFrames = measuredFrames;
+
+	m_BenchmarkFrameTimes.clear();
+	m_BenchmarkFrameTimes.reserve(measuredFrames);
+}
+
+BenchmarkResult Timer::GetBenchmarkResult() const
+{
+	BenchmarkResult result{};
+	result.warmupFrameCount = m_BenchmarkWarmupFrames;
+	result.frameCount = static_cast<uint32_t>(m_BenchmarkFrameTimes.size());
+	if (m_BenchmarkFrameTimes.empty())
+		return result;
+
+	std::vector<float> frameTimes{ m_BenchmarkFrameTimes };
+	std::sort(frameTimes.begin(), frameTimes.end());
+
+	//Nearest rank, the smallest frame time that at least the given fraction of the frames doesn't exceed
+	auto const percentile{ [&frameTimes](float fraction)
+	{
+		size_t const rank{ static_cast<size_t>(std::ceil(fraction * frameTimes.size())) };
+		return frameTimes[std::clamp<size_t>(rank, 1, frameTimes.size()) - 1];
+	} };
+
+	size_t const middle{ frameTimes.size() / 2 };
+	result.mean = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0) / frameTimes.size();
+	result.median = frameTimes.size() % 2 ? frameTimes[middle] : (frameTimes[middle - 1] + frameTimes[middle]) * .5f;
+	result.p95 = percentile(.95f);
+	result.p99 = percentile(.99f);
+	result.max = frameTimes.back();
+	result.overBudgetCount = static_cast<uint32_t>(frameTimes.end() - std::upper_bound(frameTimes.begin(), frameTimes.end(), m_FrameBudget));
+
+	return result;
+}
+
+void Timer::ResetFrameTimes()
+{
+	m_FrameTimes.Clear();
+	m_OverBudgetCount = 0;
+	m_Spikes.clear();
+	m_SpikeCount = 0;
+}
+
 void Timer::Stop()
 {
 	if (!m_IsStopped)
@@ -2,9 +2,39 @@
 
 //Standard includes
 #include <cstdint>
+#include <deque>
+#include <vector>
+
+//Project includes
+#include "FrameTimeHistogram.h"
 
 namespace dae
 {
+	//Frame times of the measured benchmark frames, milliseconds
+	struct BenchmarkResult
+	{
+		uint32_t warmupFrameCount{};
+		uint32_t frameCount{};
+		float mean{};
+		float median{};
+		float p95{};
+		float p99{};
+		float max{};
+		//measured frames slower than the frame budget of the timer
+		uint32_t overBudgetCount{};
+	};
+
+	//A frame that took much longer than the frames around it
+	struct FrameSpike
+	{
+		//seconds since the timer was reset, when the frame ended
+		float time{};
+		//milliseconds
+		float frameTime{};
+		//median of the recent frames at the time
+		float median{};
+	};
+
 	class Timer
 	{
 	public:
@@ -27,6 +57,28 @@ namespace dae
 		float GetTotal() const { return m_TotalTime; };
 		bool IsRunning() const { return !m_IsStopped; };
 
+		//Skips warmupFrames, then records the time of every frame until measuredFrames are recorded
+		void StartBenchmark(uint32_t warmupFrames = 60, uint32_t measuredFrames = 600);
+		//Warming up or measuring, input should be ignored so every run draws the same frames
+		bool IsBenchmarking() const { return m_IsBenchmarking; };
+		//The frame that is being drawn will be recorded by the next Update
+		bool IsMeasuring() const { return m_IsBenchmarking && m_BenchmarkWarmupLeft == 0; };
+		bool IsBenchmarkDone() const { return !m_IsBenchmarking && !m_BenchmarkFrameTimes.empty(); };
+		BenchmarkResult GetBenchmarkResult() const;
+
+		//Unclamped frame times of the recent frames, for percentiles of the tail instead of the averaged FPS
+		FrameTimeHistogram const& GetFrameTimes() const { return m_FrameTimes; };
+		//Milliseconds a frame may take, 60 FPS by default
+		void SetFrameBudget(float milliseconds) { m_FrameBudget = milliseconds; };
+		float GetFrameBudget() const { return m_FrameBudget; };
+		//Frames since the reset that took longer than the budget
+		uint64_t GetOverBudgetCount() const { return m_OverBudgetCount; };
+		//The last MaxSpikes frames slower than SpikeFactor times the median, oldest first
+		std::deque<FrameSpike> const& GetSpikes() const { return m_Spikes; };
+		//Spikes since the reset, including the ones that no longer fit the log
+		uint64_t GetSpikeCount() const { return m_SpikeCount; };
+		void ResetFrameTimes();
+
 	private:
 		uint64_t m_BaseTime = 0;
 		uint64_t m_PausedTime = 0;
@@ -46,5 +98,22 @@ namespace dae
 
 		bool m_IsStopped = true;
 		bool m_ForceElapsedUpperBound = false;
+
+		bool m_IsBenchmarking = false;
+		uint32_t m_BenchmarkWarmupFrames = 0;
+		uint32_t m_BenchmarkWarmupLeft = 0;
+		uint32_t m_BenchmarkFrames = 0;
+		std::vector<float> m_BenchmarkFrameTimes{};
+
+		//a spike is only told apart from the usual frame times once there are enough of them
+		static uint32_t constexpr MinSpikeFrames = 30;
+		static constexpr float SpikeFactor = 2.0f;
+		static uint32_t constexpr MaxSpikes = 64;
+
+		FrameTimeHistogram m_FrameTimes{};
+		float m_FrameBudget = 1000.0f / 60.0f;
+		uint64_t m_OverBudgetCount = 0;
+		std::deque<FrameSpike> m_Spikes{};
+		uint64_t m_SpikeCount = 0;
 	};
 }
\ No newline at end of file
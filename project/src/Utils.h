@@ -1,6 +1,7 @@
 #pragma once
 #include <cassert>
 #include <fstream>
+#include <unordered_map>
 #include "Maths.h"
 #include "DataTypes.h"
 
@@ -10,7 +11,7 @@ namespace dae
 {
 	namespace Utils
 	{
-		[[nodiscard]] float CalculateObservedArea(const Vector3& normal, const Vector3& lightDirection)
+		[[nodiscard]] inline float CalculateObservedArea(const Vector3& normal, const Vector3& lightDirection)
 		{
 			float const observedArea{ Vector3::Dot(normal, -lightDirection) };
 			if (observedArea < 0.f)
@@ -19,7 +20,7 @@ namespace dae
 			return observedArea;
 		}
 
-		[[nodiscard]] bool IsPixelInTriangle(Vector2 pixel, std::vector<Vector2> const& triangle)
+		[[nodiscard]] inline bool IsPixelInTriangle(Vector2 pixel, std::vector<Vector2> const& triangle)
 		{
 			for (uint32_t i{ 0 }; i < triangle.size(); ++i)
 			{
@@ -36,6 +37,27 @@ namespace dae
 		}
 
 
+		//Position, uv and normal index of an OBJ face corner, corners with the same key are welded into one vertex
+		struct ObjVertexKey final
+		{
+			uint32_t position{};
+			uint32_t uv{};
+			uint32_t normal{};
+
+			bool operator==(ObjVertexKey const&) const = default;
+		};
+
+		struct ObjVertexKeyHash final
+		{
+			size_t operator()(ObjVertexKey const& key) const noexcept
+			{
+				uint64_t hash{ key.position * 0x9E3779B97F4A7C15ull };
+				hash = (hash ^ (hash >> 32) ^ key.uv) * 0x9E3779B97F4A7C15ull;
+				hash = (hash ^ (hash >> 32) ^ key.normal) * 0x9E3779B97F4A7C15ull;
+				return size_t(hash ^ (hash >> 32));
+			}
+		};
+
 		//Just parses vertices and indices
 #pragma warning(push)
 #pragma warning(disable : 4505) //Warning unreferenced local function
@@ -60,6 +82,9 @@ namespace dae
 			vertices.clear();
 			indices.clear();
 
+			//OBJ indices of a face corner -> index in vertices, so the output is an indexed mesh
+			std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash> vertexLookup{};
+
 			std::string sCommand;
 			// start a while iteration ending when the end of file is reached (ios::eof)
 			while (!file.eof())
@@ -103,7 +128,7 @@ namespace dae
 					//
 					// Faces or triangles
 					Vertex vertex{};
-					size_t iPosition, iTexCoord, iNormal;
+					size_t iPosition{}, iTexCoord{}, iNormal{};
 
 					uint32_t tempIndices[3];
 					for (size_t iFace = 0; iFace < 3; iFace++)
@@ -133,9 +158,13 @@ namespace dae
 							}
 						}
 
-						vertices.push_back(vertex);
-						tempIndices[iFace] = uint32_t(vertices.size()) - 1;
-						//indices.push_back(uint32_t(vertices.size()) - 1);
+						//Reuse the vertex if this position/uv/normal combination was seen before
+						ObjVertexKey const key{ uint32_t(iPosition), uint32_t(iTexCoord), uint32_t(iNormal) };
+						auto const [it, isNew] { vertexLookup.try_emplace(key, uint32_t(vertices.size())) };
+						if (isNew)
+							vertices.push_back(vertex);
+
+						tempIndices[iFace] = it->second;
 					}
 
 					indices.push_back(tempIndices[0]);
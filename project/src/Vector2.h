@@ -1,50 +1,137 @@
 #pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "MathHelpers.h"
 
 namespace dae
 {
+	//Inline so the operators in the rasterizer loops compile to a few instructions instead of calls
 	struct Vector2
 	{
 		float x{};
 		float y{};
 
 		Vector2() = default;
-		Vector2(float _x, float _y);
-		Vector2(const Vector2& from, const Vector2& to);
+		constexpr Vector2(float _x, float _y) : x(_x), y(_y) {}
+		constexpr Vector2(const Vector2& from, const Vector2& to) : x(to.x - from.x), y(to.y - from.y) {}
+
+		[[nodiscard]] static constexpr Vector2 Min(const Vector2& v1, const Vector2& v2) noexcept
+		{
+			return { std::min(v1.x, v2.x), std::min(v1.y, v2.y) };
+		}
+		[[nodiscard]] static constexpr Vector2 Max(const Vector2& v1, const Vector2& v2) noexcept
+		{
+			return { std::max(v1.x, v2.x), std::max(v1.y, v2.y) };
+		}
 
-		[[nodiscard]] static Vector2 Min(const Vector2& v1, const Vector2& v2) noexcept;
-		[[nodiscard]] static Vector2 Max(const Vector2& v1, const Vector2& v2) noexcept;
+		float Magnitude() const
+		{
+			return sqrtf(x * x + y * y);
+		}
+		constexpr float SqrMagnitude() const
+		{
+			return x * x + y * y;
+		}
+		float Normalize()
+		{
+			const float m = Magnitude();
+			x /= m;
+			y /= m;
 
-		float Magnitude() const;
-		float SqrMagnitude() const;
-		float Normalize();
-		Vector2 Normalized() const;
+			return m;
+		}
+		Vector2 Normalized() const
+		{
+			const float m = Magnitude();
+			return { x / m, y / m };
+		}
 
-		static float Dot(const Vector2& v1, const Vector2& v2);
-		static float Cross(const Vector2& v1, const Vector2& v2);
+		static constexpr float Dot(const Vector2& v1, const Vector2& v2)
+		{
+			return v1.x * v2.x + v1.y * v2.y;
+		}
+		static constexpr float Cross(const Vector2& v1, const Vector2& v2)
+		{
+			return v1.x * v2.y - v1.y * v2.x;
+		}
 
+#pragma region Operator Overloads
 		//Member Operators
-		Vector2 operator*(float scale) const;
-		Vector2 operator/(float scale) const;
-		Vector2 operator+(const Vector2& v) const;
-		Vector2 operator-(const Vector2& v) const;
-		Vector2 operator-() const;
+		constexpr Vector2 operator*(float scale) const
+		{
+			return { x * scale, y * scale };
+		}
+		constexpr Vector2 operator/(float scale) const
+		{
+			return { x / scale, y / scale };
+		}
+		constexpr Vector2 operator+(const Vector2& v) const
+		{
+			return { x + v.x, y + v.y };
+		}
+		constexpr Vector2 operator-(const Vector2& v) const
+		{
+			return { x - v.x, y - v.y };
+		}
+		constexpr Vector2 operator-() const
+		{
+			return { -x ,-y };
+		}
 		//Vector2& operator-();
-		Vector2& operator+=(const Vector2& v);
-		Vector2& operator-=(const Vector2& v);
-		Vector2& operator/=(float scale);
-		Vector2& operator*=(float scale);
-		float& operator[](int index);
-		float operator[](int index) const;
+		constexpr Vector2& operator+=(const Vector2& v)
+		{
+			x += v.x;
+			y += v.y;
+			return *this;
+		}
+		constexpr Vector2& operator-=(const Vector2& v)
+		{
+			x -= v.x;
+			y -= v.y;
+			return *this;
+		}
+		constexpr Vector2& operator/=(float scale)
+		{
+			x /= scale;
+			y /= scale;
+			return *this;
+		}
+		constexpr Vector2& operator*=(float scale)
+		{
+			x *= scale;
+			y *= scale;
+			return *this;
+		}
+		constexpr float& operator[](int index)
+		{
+			assert(index <= 1 && index >= 0);
+			return index == 0 ? x : y;
+		}
+		constexpr float operator[](int index) const
+		{
+			assert(index <= 1 && index >= 0);
+			return index == 0 ? x : y;
+		}
 
-		bool operator==(const Vector2& v) const;
+		bool operator==(const Vector2& v) const
+		{
+			return AreEqual(x, v.x) && AreEqual(y, v.y);
+		}
+#pragma endregion
 
 		static const Vector2 UnitX;
 		static const Vector2 UnitY;
 		static const Vector2 Zero;
 	};
 
+	inline const Vector2 Vector2::UnitX = Vector2{ 1, 0 };
+	inline const Vector2 Vector2::UnitY = Vector2{ 0, 1 };
+	inline const Vector2 Vector2::Zero = Vector2{ 0, 0 };
+
 	//Global Operators
-	inline Vector2 operator*(float scale, const Vector2& v)
+	constexpr Vector2 operator*(float scale, const Vector2& v)
 	{
 		return { v.x * scale, v.y * scale };
 	}
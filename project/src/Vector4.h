@@ -1,9 +1,16 @@
 #pragma once
+#include <cassert>
+#include <cmath>
+#include <type_traits>
+
+#include "MathHelpers.h"
+#include "Simd.h"
+#include "Vector2.h"
+#include "Vector3.h"
 
 namespace dae
 {
-	struct Vector2;
-	struct Vector3;
+	//Inline like the other vectors, the arithmetic runs on the SIMD backend of Simd.h
 	struct Vector4
 	{
 		float x;
@@ -12,26 +19,120 @@ namespace dae
 		float w;
 
 		Vector4() = default;
-		Vector4(float _x, float _y, float _z, float _w);
-		Vector4(const Vector3& v, float _w);
+		constexpr Vector4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+		constexpr Vector4(const Vector3& v, float _w) : x(v.x), y(v.y), z(v.z), w(_w) {}
+
+		float Magnitude() const
+		{
+			return sqrtf(SqrMagnitude());
+		}
+		float SqrMagnitude() const
+		{
+			return Dot(*this, *this);
+		}
+		float Normalize()
+		{
+			const float m = Magnitude();
+			x /= m;
+			y /= m;
+			z /= m;
+			w /= m;
 
-		float Magnitude() const;
-		float SqrMagnitude() const;
-		float Normalize();
-		Vector4 Normalized() const;
+			return m;
+		}
+		Vector4 Normalized() const
+		{
+			const float m = Magnitude();
+			return { x / m, y / m, z / m, w / m };
+		}
 
-		Vector2 GetXY() const;
-		Vector3 GetXYZ() const;
+		constexpr Vector2 GetXY() const
+		{
+			return { x, y };
+		}
+		constexpr Vector3 GetXYZ() const
+		{
+			return { x,y,z };
+		}
 
-		static float Dot(const Vector4& v1, const Vector4& v2);
+		static float Dot(const Vector4& v1, const Vector4& v2)
+		{
+			return simd::Dot4(v1.Load(), v2.Load());
+		}
 
+#pragma region Operator Overloads
 		// operator overloading
-		Vector4 operator*(float scale) const;
-		Vector4 operator+(const Vector4& v) const;
-		Vector4 operator-(const Vector4& v) const;
-		Vector4& operator+=(const Vector4& v);
-		float& operator[](int index);
-		float operator[](int index) const;
-		bool operator==(const Vector4& v) const;
+		Vector4 operator*(float scale) const
+		{
+			return FromSimd(simd::Mul(Load(), simd::Splat(scale)));
+		}
+		Vector4 operator+(const Vector4& v) const
+		{
+			return FromSimd(simd::Add(Load(), v.Load()));
+		}
+		Vector4 operator-(const Vector4& v) const
+		{
+			return FromSimd(simd::Sub(Load(), v.Load()));
+		}
+		Vector4& operator+=(const Vector4& v)
+		{
+			Store(simd::Add(Load(), v.Load()));
+			return *this;
+		}
+		constexpr float& operator[](int index)
+		{
+			assert(index <= 3 && index >= 0);
+
+			if (index == 0)return x;
+			if (index == 1)return y;
+			if (index == 2)return z;
+			return w;
+		}
+		constexpr float operator[](int index) const
+		{
+			assert(index <= 3 && index >= 0);
+
+			if (index == 0)return x;
+			if (index == 1)return y;
+			if (index == 2)return z;
+			return w;
+		}
+		bool operator==(const Vector4& v) const
+		{
+			return AreEqual(x, v.x, .000001f) && AreEqual(y, v.y, .000001f) && AreEqual(z, v.z, .000001f) && AreEqual(w, v.w, .000001f);
+		}
+#pragma endregion
+
+		//The four floats as a register, x in the lowest lane
+		//Through a pointer to the whole vector, a pointer to x only covers x
+		simd::Float4 Load() const noexcept
+		{
+			return simd::Load(reinterpret_cast<float const*>(this));
+		}
+		void Store(simd::Float4 v) noexcept
+		{
+			simd::Store(reinterpret_cast<float*>(this), v);
+		}
+		static Vector4 FromSimd(simd::Float4 v) noexcept
+		{
+			Vector4 result;
+			result.Store(v);
+			return result;
+		}
 	};
+
+	static_assert(std::is_standard_layout_v<Vector4> && sizeof(Vector4) == 4 * sizeof(float), "Vector4 is loaded as four consecutive floats");
+
+	//Members of Vector3 that need the complete Vector4
+	constexpr Vector3::Vector3(const Vector4& v) : x(v.x), y(v.y), z(v.z) {}
+
+	constexpr Vector4 Vector3::ToPoint4() const
+	{
+		return { x, y, z, 1 };
+	}
+
+	constexpr Vector4 Vector3::ToVector4() const
+	{
+		return { x, y, z, 0 };
+	}
 }
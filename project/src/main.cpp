@@ -7,11 +7,24 @@
 #undef main
 
 //Standard includes
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <thread>
 
 //Project includes
 #include "Timer.h"
 #include "Renderer.h"
+#include "BatchRenderer.h"
+#include "ImageWriter.h"
+#include "RenderTarget.h"
+#include "DataTypes.h"
+#include "GoldenImage.h"
+#include "Profiler.h"
 
 using namespace dae;
 
@@ -21,11 +34,431 @@ void ShutDown(SDL_Window* pWindow)
 	SDL_Quit();
 }
 
+void PrintBatchUsage()
+{
+	std::cout << "Usage: --batch [options]\n"
+		<< "  --scene <name>       resources/<name>.obj and its textures (default vehicle)\n"
+		<< "  --size <w>x<h>       resolution (default 640x480)\n"
+		<< "  --mode <mode>        observedarea, diffuse, specular, combined or pbr\n"
+		<< "  --poses <file>       one frame per \"ox oy oz tx ty tz\" line\n"
+		<< "  --path <file>        spline through the poses in the file, sampled at --frames\n"
+		<< "  --frames <count>     frames of the path (default 120)\n"
+		<< "  --turntable <count>  orbit around the mesh (default when no poses are given)\n"
+		<< "  --threads <count>    worker threads (default all hardware threads)\n"
+		<< "  --output <dir>       where frames are written (default batch)\n"
+		<< "  --depth <format>     float32, reversed, unorm16 or fixed24 (default float32)\n"
+		<< "  --msaa <samples>     1, 2, 4 or 8 samples per pixel (default 1)\n"
+		<< "  --instances <count>  draw tinted copies of the mesh on a grid through the instanced path\n"
+		<< "  --format <format>    png, qoi, bmp or raw (default png)\n"
+		<< "  --writers <count>    threads encoding the frames (default 1)\n"
+		<< "  --no-output          only render, for measuring throughput\n"
+		<< "  --perf               count cycles, cache and branch misses per stage (Linux perf events)\n"
+		<< "  --trace <file>       write the profiler zones as a Chrome trace (needs ENABLE_PROFILER)\n";
+}
+
+void PrintGoldenUsage()
+{
+	std::cout << "Usage: --golden [options]\n"
+		<< "  --update             render the references instead of comparing against them\n"
+		<< "  --references <dir>   reference images (default golden)\n"
+		<< "  --diff <dir>         rendered and diff images of the failed comparisons (default golden_diff)\n"
+		<< "  --tolerance <0-255>  largest channel difference of a matching pixel (default 8)\n"
+		<< "  --mismatch <ratio>   fraction of the pixels allowed beyond the tolerance (default 0.01)\n"
+		<< "  --psnr <dB>          lowest peak signal-to-noise ratio (default 30)\n";
+}
+
+void WriteTrace(std::string const& path)
+{
+	if (!Profiler::IsEnabled())
+		std::cout << "The profiler is compiled out, configure with -DENABLE_PROFILER=ON to record zones" << std::endl;
+	else if (Profiler::WriteChromeTrace(path))
+		std::cout << "Wrote profiler trace to " << path << " (open in chrome://tracing or ui.perfetto.dev)" << std::endl;
+	else
+		std::cout << "Failed to write profiler trace to " << path << std::endl;
+}
+
+//Per renderer, batch workers each allocate their own
+void PrintFramebufferMemory(FramebufferMemory const& memory, uint32_t sampleCount)
+{
+	std::cout << "MSAA " << sampleCount << "x: " << memory.GetTotal() / (1024. * 1024.) << " MB (back buffers " << memory.backBuffer / (1024. * 1024.)
+		<< " MB, depth " << memory.depth / (1024. * 1024.) << " MB, sample colors " << memory.sampleColors / (1024. * 1024.) << " MB)" << std::endl;
+}
+
+void PrintPerfCountersUnavailable()
+{
+	std::cout << "Hardware counters are unavailable, they need Linux, a CPU the kernel exposes counters of (not most virtual machines) and perf_event_paranoid <= 2" << std::endl;
+}
+
+//Frame times and the average per stage of the measured frames, with what's needed to compare builds and machines
+bool WriteBenchmarkResult(std::string const& path, BenchmarkResult const& result, float frameBudget, RenderStats const& stats, uint32_t width, uint32_t height, uint32_t frameBufferCount, uint32_t sampleCount)
+{
+	std::ofstream file{ path };
+	if (!file)
+		return false;
+
+#if defined(_MSC_VER)
+	std::string const compiler{ "MSVC " + std::to_string(_MSC_VER) };
+#elif defined(__clang__)
+	std::string const compiler{ "Clang " __clang_version__ };
+#elif defined(__GNUC__)
+	std::string const compiler{ "GCC " __VERSION__ };
+#else
+	std::string const compiler{ "Unknown" };
+#endif
+#ifdef NDEBUG
+	bool constexpr isOptimized{ true };
+#else
+	bool constexpr isOptimized{ false };
+#endif
+
+	double const frameCount{ static_cast<double>(std::max(result.frameCount, 1u)) };
+	file << "{\n"
+		<< "\t\"compiler\": \"" << compiler << "\",\n"
+		<< "\t\"optimized\": " << (isOptimized ? "true" : "false") << ",\n"
+		<< "\t\"profiler\": " << (Profiler::IsEnabled() ? "true" : "false") << ",\n"
+		<< "\t\"hardwareThreads\": " << std::thread::hardware_concurrency() << ",\n"
+		<< "\t\"width\": " << width << ",\n"
+		<< "\t\"height\": " << height << ",\n"
+		<< "\t\"frameBuffers\": " << frameBufferCount << ",\n"
+		<< "\t\"samples\": " << sampleCount << ",\n"
+		<< "\t\"warmupFrames\": " << result.warmupFrameCount << ",\n"
+		<< "\t\"frames\": " << result.frameCount << ",\n"
+		<< "\t\"frameTimeMs\": { \"mean\": " << result.mean << ", \"median\": " << result.median << ", \"p95\": " << result.p95
+		<< ", \"p99\": " << result.p99 << ", \"max\": " << result.max << " },\n"
+		<< "\t\"frameBudgetMs\": " << frameBudget << ",\n"
+		<< "\t\"framesOverBudget\": " << result.overBudgetCount << ",\n"
+		<< "\t\"stageMs\": { \"cull\": " << stats.cullMs / frameCount << ", \"transform\": " << stats.transformMs / frameCount
+		<< ", \"rasterize\": " << stats.rasterizeMs / frameCount << ", \"clear\": " << stats.clearMs / frameCount
+		<< ", \"resolve\": " << stats.resolveMs / frameCount << ", \"present\": " << stats.presentMs / frameCount << ", \"render\": " << stats.frameMs / frameCount << " },\n"
+		<< "\t\"perFrame\": { \"vertices\": " << stats.verticesTransformed / frameCount << ", \"trianglesRasterized\": " << stats.trianglesRasterized / frameCount
+		<< ", \"pixelsShaded\": " << stats.pixelsShaded / frameCount << ", \"textureFetches\": " << stats.textureFetches / frameCount
+		<< ", \"sampleColorBytes\": " << stats.sampleColorBytes / frameCount << " }";
+
+	//IPC per stage, the misses per transformed vertex and per pixel tested by the rasterizer
+	if (stats.HasCounters())
+	{
+		auto const perItem{ [](uint64_t count, uint64_t items) { return items ? static_cast<double>(count) / items : 0.; } };
+		PerfCounterValues const& vertex{ stats.transformCounters };
+		PerfCounterValues const& pixel{ stats.rasterizeCounters };
+		file << ",\n\t\"ipc\": { \"cull\": " << stats.cullCounters.GetIPC() << ", \"transform\": " << vertex.GetIPC()
+			<< ", \"rasterize\": " << pixel.GetIPC() << ", \"clear\": " << stats.clearCounters.GetIPC()
+			<< ", \"resolve\": " << stats.resolveCounters.GetIPC() << ", \"present\": " << stats.presentCounters.GetIPC() << ", \"render\": " << stats.frameCounters.GetIPC() << " },\n"
+			<< "\t\"perVertex\": { \"cycles\": " << perItem(vertex.cycles, stats.verticesTransformed)
+			<< ", \"l1Misses\": " << perItem(vertex.l1DataMisses, stats.verticesTransformed)
+			<< ", \"llcMisses\": " << perItem(vertex.lastLevelMisses, stats.verticesTransformed)
+			<< ", \"branchMisses\": " << perItem(vertex.branchMisses, stats.verticesTransformed) << " },\n"
+			<< "\t\"perPixel\": { \"cycles\": " << perItem(pixel.cycles, stats.pixelsTested)
+			<< ", \"l1Misses\": " << perItem(pixel.l1DataMisses, stats.pixelsTested)
+			<< ", \"llcMisses\": " << perItem(pixel.lastLevelMisses, stats.pixelsTested)
+			<< ", \"branchMisses\": " << perItem(pixel.branchMisses, stats.pixelsTested) << " }";
+	}
+	file << "\n}\n";
+
+	return static_cast<bool>(file);
+}
+
+//Renders a camera path or list of viewpoints headless, reports the throughput
+int RunBatch(int argc, char* args[])
+{
+	BatchSettings settings{};
+	std::string scene{ "vehicle" };
+	std::string posesFile{};
+	bool isPath{ false };
+	uint32_t frameCount{ 120 };
+	//0 draws the mesh once, without instancing
+	uint32_t instanceCount{ 0 };
+	std::string traceFile{};
+
+	try
+	{
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			std::string const arg{ args[i] };
+			bool const hasValue{ i + 1 < argc };
+
+			if (arg == "--batch")
+				continue;
+			if (arg == "--no-output")
+			{
+				settings.outputDirectory.clear();
+				continue;
+			}
+			if (arg == "--perf")
+			{
+				settings.isCountingPerf = true;
+				continue;
+			}
+			if (!hasValue)
+			{
+				PrintBatchUsage();
+				return 1;
+			}
+
+			std::string const value{ args[++i] };
+			if (arg == "--scene")
+				scene = value;
+			else if (arg == "--size")
+			{
+				if (std::sscanf(value.c_str(), "%dx%d", &settings.width, &settings.height) != 2 || settings.width <= 0 || settings.height <= 0)
+				{
+					PrintBatchUsage();
+					return 1;
+				}
+			}
+			else if (arg == "--mode")
+			{
+				if (value == "observedarea")
+					settings.shadingMode = Renderer::ShadingMode::ObservedArea;
+				else if (value == "diffuse")
+					settings.shadingMode = Renderer::ShadingMode::Diffuse;
+				else if (value == "specular")
+					settings.shadingMode = Renderer::ShadingMode::Specular;
+				else if (value == "combined")
+					settings.shadingMode = Renderer::ShadingMode::Combined;
+				else if (value == "pbr")
+					settings.shadingMode = Renderer::ShadingMode::PhysicallyBased;
+				else
+				{
+					PrintBatchUsage();
+					return 1;
+				}
+			}
+			else if (arg == "--depth")
+			{
+				if (value == "float32")
+					settings.depthFormat = DepthFormat::Float32;
+				else if (value == "reversed")
+					settings.depthFormat = DepthFormat::ReversedFloat32;
+				else if (value == "unorm16")
+					settings.depthFormat = DepthFormat::Unorm16;
+				else if (value == "fixed24")
+					settings.depthFormat = DepthFormat::Fixed24;
+				else
+				{
+					PrintBatchUsage();
+					return 1;
+				}
+			}
+			else if (arg == "--msaa")
+			{
+				settings.sampleCount = static_cast<uint32_t>(std::stoul(value));
+				if (!Multisample::IsSupported(settings.sampleCount))
+				{
+					PrintBatchUsage();
+					return 1;
+				}
+			}
+			else if (arg == "--instances")
+				instanceCount = static_cast<uint32_t>(std::stoul(value));
+			else if (arg == "--poses" || arg == "--path")
+			{
+				posesFile = value;
+				isPath = arg == "--path";
+			}
+			else if (arg == "--frames" || arg == "--turntable")
+				frameCount = static_cast<uint32_t>(std::stoul(value));
+			else if (arg == "--threads")
+				settings.threadCount = static_cast<uint32_t>(std::stoul(value));
+			else if (arg == "--output")
+				settings.outputDirectory = value;
+			else if (arg == "--format")
+			{
+				if (value == "png")
+					settings.imageFormat = ImageFormat::PNG;
+				else if (value == "qoi")
+					settings.imageFormat = ImageFormat::QOI;
+				else if (value == "bmp")
+					settings.imageFormat = ImageFormat::BMP;
+				else if (value == "raw")
+					settings.imageFormat = ImageFormat::Raw;
+				else
+				{
+					PrintBatchUsage();
+					return 1;
+				}
+			}
+			else if (arg == "--writers")
+				settings.writerThreadCount = static_cast<uint32_t>(std::stoul(value));
+			else if (arg == "--trace")
+				traceFile = value;
+			else
+			{
+				PrintBatchUsage();
+				return 1;
+			}
+		}
+
+		auto const pMesh{ Renderer::LoadMesh(scene) };
+		settings.instances = BatchRenderer::CreateInstanceGrid(pMesh->boundingSphere, instanceCount);
+
+		std::vector<CameraPose> poses{};
+		if (posesFile.empty())
+			poses = BatchRenderer::Turntable(BatchRenderer::GetInstanceBounds(pMesh->boundingSphere, settings.instances), 45.f, frameCount);
+		else if (isPath)
+			poses = BatchRenderer::SamplePath(BatchRenderer::LoadPoses(posesFile), frameCount);
+		else
+			poses = BatchRenderer::LoadPoses(posesFile);
+
+		BatchRenderer const batch{ pMesh };
+		BatchResult const result{ batch.Render(poses, settings) };
+
+		std::cout << "Batch: " << result.frameCount << " frames (" << settings.width << "x" << settings.height << ") on "
+			<< result.threadCount << " threads in " << result.seconds << "s - " << result.GetFPS() << " FPS" << std::endl;
+
+		result.renderStats.Print(std::cout << "Per frame:\n", result.frameCount);
+		if (settings.isCountingPerf && !result.renderStats.HasCounters())
+			PrintPerfCountersUnavailable();
+
+		//Ties are fragments quantized to the depth already stored, where depth fighting shows up
+		DepthBuffer::Stats const& depth{ result.depthStats };
+		size_t const bytesPerPixel{ DepthBuffer::GetBytesPerPixel(settings.depthFormat) };
+		std::cout << "Depth: " << DepthBuffer::GetName(settings.depthFormat) << " (" << bytesPerPixel << " bytes per sample) - "
+			<< depth.GetBytes(bytesPerPixel) / (1024. * 1024.) / result.frameCount << " MB per frame, "
+			<< depth.GetTieRate() * 100.f << "% of " << depth.tests / result.frameCount << " tests per frame tied" << std::endl;
+
+		PrintFramebufferMemory(Renderer::GetFramebufferMemory(settings.width, settings.height, settings.depthFormat, settings.sampleCount), settings.sampleCount);
+		std::cout << "Depth and sample color traffic: " << (depth.GetBytes(bytesPerPixel) + result.renderStats.sampleColorBytes) / (1024. * 1024.) / result.frameCount
+			<< " MB per frame" << std::endl;
+
+		if (!traceFile.empty())
+			WriteTrace(traceFile);
+
+		if (result.failedWrites)
+		{
+			std::cout << result.failedWrites << " frames could not be written to " << settings.outputDirectory << std::endl;
+			return 1;
+		}
+	}
+	catch (std::exception const& e)
+	{
+		std::cout << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+//Compares the shading modes of fixed scenes against reference images, exits with 1 when any of them differs
+int RunGolden(int argc, char* args[])
+{
+	GoldenSettings settings{};
+
+	try
+	{
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			std::string const arg{ args[i] };
+			bool const hasValue{ i + 1 < argc };
+
+			if (arg == "--golden")
+				continue;
+			if (arg == "--update")
+			{
+				settings.isUpdating = true;
+				continue;
+			}
+			if (!hasValue)
+			{
+				PrintGoldenUsage();
+				return 1;
+			}
+
+			std::string const value{ args[++i] };
+			if (arg == "--references")
+				settings.referenceDirectory = value;
+			else if (arg == "--diff")
+				settings.diffDirectory = value;
+			else if (arg == "--tolerance")
+				settings.tolerance = static_cast<uint8_t>(std::clamp(std::stoi(value), 0, 255));
+			else if (arg == "--mismatch")
+				settings.maxMismatchRatio = std::stod(value);
+			else if (arg == "--psnr")
+				settings.minPSNR = std::stod(value);
+			else
+			{
+				PrintGoldenUsage();
+				return 1;
+			}
+		}
+
+		std::vector<GoldenResult> const results{ GoldenImage::Run(settings) };
+
+		uint32_t failedCount{ 0 };
+		for (auto const& result : results)
+		{
+			if (!result.isPassed)
+				++failedCount;
+
+			std::cout << result.name << ": ";
+			if (settings.isUpdating)
+				std::cout << (result.isPassed ? "updated" : "failed to write") << std::endl;
+			else if (!result.hasReference)
+				std::cout << "no reference of " << settings.width << "x" << settings.height << " - FAILED" << std::endl;
+			else if (result.maxDifference == 0)
+				std::cout << "identical - passed" << std::endl;
+			else
+				std::cout << "PSNR " << result.psnr << "dB, max difference " << static_cast<int>(result.maxDifference) << ", "
+					<< result.mismatchedPixels << " pixels beyond tolerance - " << (result.isPassed ? "passed" : "FAILED") << std::endl;
+		}
+
+		if (settings.isUpdating)
+			std::cout << "Wrote " << results.size() - failedCount << " references to " << settings.referenceDirectory.string() << std::endl;
+		else if (failedCount)
+			std::cout << failedCount << " of " << results.size() << " images differ, see " << settings.diffDirectory.string() << std::endl;
+		else
+			std::cout << "All " << results.size() << " images match" << std::endl;
+
+		return failedCount ? 1 : 0;
+	}
+	catch (std::exception const& e)
+	{
+		std::cout << e.what() << std::endl;
+		return 1;
+	}
+}
+
 int main(int argc, char* args[])
 {
-	//Unreferenced parameters
-	(void)argc;
-	(void)args;
+	//Frames in flight: 1 presents on the render thread, 2 overlaps presenting a frame with drawing the next, 3 allows two queued frames
+	uint32_t frameBufferCount = 2;
+	//Benchmark: the default view with a fixed rotation per frame, input is ignored
+	bool isBenchmark = false;
+	uint32_t benchmarkWarmupFrames = 60;
+	uint32_t benchmarkFrames = 600;
+	std::string benchmarkOutput = "benchmark.json";
+	bool isCountingPerf = false;
+	//Frames slower than this are counted, 60 FPS by default
+	float frameBudget = 1000.0f / 60.0f;
+	uint32_t sampleCount = 1;
+	for (int i{ 1 }; i < argc; ++i)
+	{
+		if (std::strcmp(args[i], "--batch") == 0)
+			return RunBatch(argc, args);
+		if (std::strcmp(args[i], "--golden") == 0)
+			return RunGolden(argc, args);
+
+		if (std::strcmp(args[i], "--benchmark") == 0)
+			isBenchmark = true;
+		if (std::strcmp(args[i], "--perf") == 0)
+			isCountingPerf = true;
+
+		if (std::strcmp(args[i], "--buffers") == 0 && i + 1 < argc)
+			frameBufferCount = static_cast<uint32_t>(std::clamp(std::atoi(args[++i]), 1, 3));
+		else if (std::strcmp(args[i], "--warmup") == 0 && i + 1 < argc)
+			benchmarkWarmupFrames = static_cast<uint32_t>(std::max(std::atoi(args[++i]), 0));
+		else if (std::strcmp(args[i], "--frames") == 0 && i + 1 < argc)
+			benchmarkFrames = static_cast<uint32_t>(std::max(std::atoi(args[++i]), 1));
+		else if (std::strcmp(args[i], "--output") == 0 && i + 1 < argc)
+			benchmarkOutput = args[++i];
+		else if (std::strcmp(args[i], "--budget") == 0 && i + 1 < argc)
+			frameBudget = static_cast<float>(std::max(std::atof(args[++i]), 0.1));
+		else if (std::strcmp(args[i], "--msaa") == 0 && i + 1 < argc)
+		{
+			uint32_t const samples = static_cast<uint32_t>(std::max(std::atoi(args[++i]), 1));
+			if (Multisample::IsSupported(samples))
+				sampleCount = samples;
+		}
+	}
 
 	//Create window + surfaces
 	SDL_Init(SDL_INIT_VIDEO);
@@ -42,19 +475,39 @@ int main(int argc, char* args[])
 	if (!pWindow)
 		return 1;
 
+	Profiler::SetThreadName("Main");
+
 	//Initialize "framework"
 	const auto pTimer = new Timer();
-	const auto pRenderer = new Renderer(pWindow);
+	pTimer->SetFrameBudget(frameBudget);
+	const auto pRenderer = new Renderer(std::make_unique<WindowRenderTarget>(pWindow, frameBufferCount));
+	pRenderer->SetSampleCount(sampleCount);
+	//Screenshots and captured sequences are encoded in the background
+	const auto pImageWriter = new ImageWriter();
+
+	//Hardware events per stage, shown with the stats and written with the benchmark result
+	if (isCountingPerf && !pRenderer->EnablePerfCounters())
+		PrintPerfCountersUnavailable();
 
 	//Start loop
 	pTimer->Start();
 
 	// Start Benchmark
-	// TODO pTimer->StartBenchmark();
+	if (isBenchmark)
+	{
+		std::cout << "Benchmark: " << benchmarkWarmupFrames << " warmup frames, " << benchmarkFrames << " measured frames" << std::endl;
+		PrintFramebufferMemory(pRenderer->GetFramebufferMemory(), pRenderer->GetSampleCount());
+		pTimer->StartBenchmark(benchmarkWarmupFrames, benchmarkFrames);
+	}
+	RenderStats benchmarkStats{};
 
 	float printTimer = 0.f;
 	bool isLooping = true;
 	bool takeScreenshot = false;
+	bool isCapturing = false;
+	bool showStats = false;
+	uint32_t captureFrame = 0;
+	uint64_t printedSpikes = 0;
 	while (isLooping)
 	{
 		//--------- Get input events ---------
@@ -67,12 +520,25 @@ int main(int argc, char* args[])
 				isLooping = false;
 				break;
 			case SDL_KEYUP:
+				//Settings stay fixed so every benchmark run draws the same frames
+				if (pTimer->IsBenchmarking())
+					break;
+
 				if (e.key.keysym.scancode == SDL_SCANCODE_X)
 					takeScreenshot = true;
 
 				if (e.key.keysym.scancode == SDL_SCANCODE_F1)
 					pRenderer->ToggleBoundingBoxes();
 
+				if (e.key.keysym.scancode == SDL_SCANCODE_F2)
+					showStats = !showStats;
+
+				if (e.key.keysym.scancode == SDL_SCANCODE_F3)
+				{
+					pRenderer->CycleSampleCount();
+					PrintFramebufferMemory(pRenderer->GetFramebufferMemory(), pRenderer->GetSampleCount());
+				}
+
 				if (e.key.keysym.scancode == SDL_SCANCODE_F4)
 					pRenderer->ToggleDepthBuffer();
 
@@ -85,6 +551,30 @@ int main(int argc, char* args[])
 				if (e.key.keysym.scancode == SDL_SCANCODE_F7)
 					pRenderer->CycleShadingMode();
 
+				if (e.key.keysym.scancode == SDL_SCANCODE_F8)
+					pRenderer->ToggleLOD();
+
+				if (e.key.keysym.scancode == SDL_SCANCODE_F9)
+				{
+					isCapturing = !isCapturing;
+					if (isCapturing)
+					{
+						std::filesystem::create_directories("capture");
+						captureFrame = 0;
+					}
+					std::cout << (isCapturing ? "Capturing frames to capture/" : "Capture stopped") << std::endl;
+				}
+
+				if (e.key.keysym.scancode == SDL_SCANCODE_F10)
+				{
+					pRenderer->CycleDepthFormat();
+					std::cout << "Depth format: " << DepthBuffer::GetName(pRenderer->GetDepthBuffer().GetFormat()) << std::endl;
+				}
+
+				//The last frames of every thread
+				if (e.key.keysym.scancode == SDL_SCANCODE_F11)
+					WriteTrace("Rasterizer_Trace.json");
+
 				break;
 			}
 		}
@@ -93,30 +583,73 @@ int main(int argc, char* args[])
 		pRenderer->Update(pTimer);
 
 		//--------- Render ---------
-		pRenderer->Render();
+		//Nothing changed, wait for input instead of spinning (the timeout keeps the timer and fps print going)
+		if (pRenderer->Render())
+		{
+			//Sequences only hold rendered frames, QOI keeps up with the frame rate where PNG wouldn't
+			if (isCapturing)
+				pImageWriter->Submit(pRenderer->GetRenderTarget(), ImageWriter::GetSequencePath("capture", captureFrame++, ImageFormat::QOI), ImageFormat::QOI);
+		}
+		else
+			SDL_WaitEventTimeout(nullptr, 16);
+
+		//Recorded before the timer update that records the time of this frame
+		if (pTimer->IsMeasuring())
+			benchmarkStats += pRenderer->GetStats();
 
 		//--------- Timer ---------
 		pTimer->Update();
+
+		if (isBenchmark && pTimer->IsBenchmarkDone())
+		{
+			BenchmarkResult const result{ pTimer->GetBenchmarkResult() };
+			std::cout << "Benchmark: " << result.frameCount << " frames - mean " << result.mean << "ms, median " << result.median
+				<< "ms, p95 " << result.p95 << "ms, p99 " << result.p99 << "ms, max " << result.max << "ms - "
+				<< result.overBudgetCount << " over the " << pTimer->GetFrameBudget() << "ms budget" << std::endl;
+			benchmarkStats.Print(std::cout, result.frameCount);
+
+			if (WriteBenchmarkResult(benchmarkOutput, result, pTimer->GetFrameBudget(), benchmarkStats, width, height, frameBufferCount, pRenderer->GetSampleCount()))
+				std::cout << "Wrote benchmark result to " << benchmarkOutput << std::endl;
+			else
+				std::cout << "Failed to write benchmark result to " << benchmarkOutput << std::endl;
+
+			isLooping = false;
+		}
 		printTimer += pTimer->GetElapsed();
 		if (printTimer >= 1.f)
 		{
 			printTimer = 0.f;
 			std::cout << "dFPS: " << pTimer->GetdFPS() << std::endl;
+			if (showStats)
+			{
+				pRenderer->GetStats().Print(std::cout);
+
+				//Tail of the recent frames, the spikes since the last print
+				FrameTimeHistogram const& frameTimes{ pTimer->GetFrameTimes() };
+				std::cout << "Frame time: p50 " << frameTimes.GetPercentile(.5f) << "ms, p99 " << frameTimes.GetPercentile(.99f)
+					<< "ms, max " << frameTimes.GetMax() << "ms over " << frameTimes.GetCount() << " frames - "
+					<< pTimer->GetOverBudgetCount() << " over the " << pTimer->GetFrameBudget() << "ms budget" << std::endl;
+
+				std::deque<FrameSpike> const& spikes{ pTimer->GetSpikes() };
+				uint64_t const newSpikes{ std::min<uint64_t>(pTimer->GetSpikeCount() - printedSpikes, spikes.size()) };
+				for (auto it{ spikes.end() - static_cast<std::ptrdiff_t>(newSpikes) }; it != spikes.end(); ++it)
+					std::cout << "Spike at " << it->time << "s: " << it->frameTime << "ms (median " << it->median << "ms)" << std::endl;
+			}
+			printedSpikes = pTimer->GetSpikeCount();
 		}
 
-		//Save screenshot after full render
+		//Save screenshot after full render, failures are reported by the writer
 		if (takeScreenshot)
 		{
-			if (!pRenderer->SaveBufferToImage())
-				std::cout << "Screenshot saved!" << std::endl;
-			else
-				std::cout << "Something went wrong. Screenshot not saved!" << std::endl;
+			pImageWriter->Submit(pRenderer->GetRenderTarget(), "Rasterizer_ColorBuffer.png");
+			std::cout << "Saving screenshot to Rasterizer_ColorBuffer.png" << std::endl;
 			takeScreenshot = false;
 		}
 	}
 	pTimer->Stop();
 
-	//Shutdown "framework"
+	//Shutdown "framework", frames that are still queued are written first
+	delete pImageWriter;
 	delete pRenderer;
 	delete pTimer;
 